@@ -0,0 +1,187 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Types.h"
+
+/// Segment of an air command symbol, i.e. a constant signal level.
+struct AirSegment {
+    /// Signal level, true for a high signal.
+    bool level;
+
+    /// Length in twelfths of the data or sync element length.
+    uint8_t twelfths;
+
+    /// True if the length refers to the sync element length.
+    bool isSync;
+};
+
+/// Air command symbol, i.e. the segments transmitted for a character.
+struct AirSymbol {
+    /// Maximum number of segments of a symbol.
+    static const size_t MAX_SEGMENTS = 3U;
+
+    /// Air command character.
+    char character;
+
+    /// Number of segments used.
+    uint8_t segmentCount;
+
+    /// Segments of the symbol.
+    AirSegment segments[MAX_SEGMENTS];
+
+    /// Get the first segment.
+    constexpr const AirSegment * begin(void) const {
+        return segments;
+    }
+
+    /// Get the end of the segments.
+    constexpr const AirSegment * end(void) const {
+        return segments + segmentCount;
+    }
+};
+
+/**
+ * @brief Encoding traits of an air code.
+ *
+ * Each specialization defines the name and the symbol alphabet of an air code
+ * at compile time. The encoder of the target control is instantiated per air
+ * code from these traits, the alphabet checks of the target parameters and
+ * the learner use the same definitions.
+ *
+ * @tparam CODE Air code.
+ */
+template <Types::AirCode::AirCode_ CODE>
+struct AirCodeTraits;
+
+/// Manchester: falling or rising edge in the middle, sync low or high.
+template <>
+struct AirCodeTraits<Types::AirCode::MANCHESTER> {
+    /// Name of the encoding.
+    static constexpr const char * NAME = "Manchester";
+
+    /// Number of symbols.
+    static constexpr size_t SYMBOL_COUNT = 4U;
+
+    /// Symbols of the encoding.
+    static constexpr AirSymbol SYMBOLS[SYMBOL_COUNT] = {
+        { '0', 2U, { { true, 6U, false }, { false, 6U, false } } },
+        { '1', 2U, { { false, 6U, false }, { true, 6U, false } } },
+        { 's', 1U, { { false, 12U, true } } },
+        { 'S', 1U, { { true, 12U, true } } }
+    };
+};
+
+/// Remote controlled outlet: falling edge after 25% or 75%.
+template <>
+struct AirCodeTraits<Types::AirCode::REMOTE_CONTROLLED_OUTLET> {
+    /// Name of the encoding.
+    static constexpr const char * NAME = "RCO";
+
+    /// Number of symbols.
+    static constexpr size_t SYMBOL_COUNT = 2U;
+
+    /// Symbols of the encoding.
+    static constexpr AirSymbol SYMBOLS[SYMBOL_COUNT] = {
+        { '0', 2U, { { true, 3U, false }, { false, 9U, false } } },
+        { '1', 2U, { { true, 9U, false }, { false, 3U, false } } }
+    };
+};
+
+/// Tormatic: falling edge after 33%, another rising edge after 66% for '1'.
+template <>
+struct AirCodeTraits<Types::AirCode::TORMATIC> {
+    /// Name of the encoding.
+    static constexpr const char * NAME = "Tormatic";
+
+    /// Number of symbols.
+    static constexpr size_t SYMBOL_COUNT = 2U;
+
+    /// Symbols of the encoding.
+    static constexpr AirSymbol SYMBOLS[SYMBOL_COUNT] = {
+        { '0', 2U, { { true, 4U, false }, { false, 8U, false } } },
+        { '1', 3U, { { true, 4U, false }, { false, 4U, false },
+            { true, 4U, false } } }
+    };
+};
+
+/// Melitec: falling edge after 33% of data or 66% of sync elements.
+template <>
+struct AirCodeTraits<Types::AirCode::MELITEC> {
+    /// Name of the encoding.
+    static constexpr const char * NAME = "Melitec";
+
+    /// Number of symbols.
+    static constexpr size_t SYMBOL_COUNT = 2U;
+
+    /// Symbols of the encoding.
+    static constexpr AirSymbol SYMBOLS[SYMBOL_COUNT] = {
+        { '0', 2U, { { true, 4U, false }, { false, 8U, false } } },
+        { 'S', 2U, { { true, 8U, true }, { false, 4U, true } } }
+    };
+};
+
+/// Class providing runtime access to the traits of all air codes.
+class AirCodes {
+public:
+    /// Range of symbols of an air code.
+    struct Symbols {
+        /// First symbol.
+        const AirSymbol * first;
+
+        /// End of the symbols.
+        const AirSymbol * last;
+
+        /// Get the first symbol.
+        const AirSymbol * begin(void) const {
+            return first;
+        }
+
+        /// Get the end of the symbols.
+        const AirSymbol * end(void) const {
+            return last;
+        }
+
+        /// Get the number of symbols.
+        size_t size(void) const {
+            return static_cast<size_t>(last - first);
+        }
+    };
+
+    /// Get the symbols of the given air code.
+    static Symbols getSymbols(const Types::AirCode::AirCode_ airCode);
+
+    /// Get the name of the given air code.
+    static const char * getName(const Types::AirCode::AirCode_ airCode);
+
+    /// Get all characters allowed in air commands of the given air code.
+    static std::string getAlphabet(const Types::AirCode::AirCode_ airCode);
+
+private:
+    /// Get the symbols of the air code described by the given traits.
+    template <typename Traits>
+    static Symbols getSymbols(void) {
+        return { Traits::SYMBOLS, Traits::SYMBOLS + Traits::SYMBOL_COUNT };
+    }
+};
@@ -0,0 +1,85 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "AirtimeParameters.h"
+
+/**
+ * @brief Class limiting the airtime of all GPIO pins to a duty cycle.
+ *
+ * Each GPIO pin has a token bucket holding up to duty cycle times period
+ * microseconds of airtime, refilled at the rate of the duty cycle. The
+ * buckets are stored in a state file shared by all program invocations and
+ * locked while being updated, i.e. concurrent and successive invocations
+ * respect the same budget.
+ */
+class Airtime {
+public:
+    /// Class constructor.
+    explicit Airtime(const AirtimeParameters & parameters);
+
+    /// Take the given airtime from the buckets of the given GPIO pins.
+    bool acquire(const std::map<uint8_t, uint64_t> & airtimeUs) const;
+
+    /// Return unused airtime to the buckets of the given GPIO pins.
+    bool release(const std::map<uint8_t, uint64_t> & airtimeUs) const;
+
+private:
+    /// Token bucket of a single GPIO pin.
+    struct Bucket {
+        /**
+         * @brief Available airtime.
+         * @note Unit: microseconds
+         */
+        double tokensUs;
+
+        /**
+         * @brief Wall clock time of the last update.
+         * @note Unit: microseconds
+         */
+        uint64_t updatedUs;
+    };
+
+    /// Reference of the airtime parameters.
+    const AirtimeParameters & parameters_;
+
+    /// Get the capacity of each bucket.
+    double getCapacity(void) const;
+
+    /// Refill the bucket of the given GPIO pin up to the given time.
+    Bucket & refill(std::map<uint8_t, Bucket> & buckets,
+        const uint8_t gpioPin, const uint64_t nowUs) const;
+
+    /**
+     * @brief Get the current wall clock time, which is valid across reboots.
+     * @note Unit: microseconds
+     */
+    static uint64_t now(void);
+
+    /// Read all buckets from the locked state file.
+    static bool read(const int fd, std::map<uint8_t, Bucket> & buckets);
+
+    /// Write all buckets to the locked state file.
+    static bool save(const int fd, const std::map<uint8_t, Bucket> & buckets);
+};
@@ -0,0 +1,94 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Configuration.h"
+
+/// Class holding all parameters required for the airtime limiter.
+class AirtimeParameters {
+public:
+    /// Policies applied if the airtime budget is exhausted.
+    struct Policy {
+        /// Policies applied if the airtime budget is exhausted.
+        enum Policy_ {
+            DEFER = 0,
+            REJECT = 1,
+            MAX
+        };
+    };
+
+    /// Class constructor.
+    AirtimeParameters(const Configuration & configuration);
+
+    /**
+     * @brief Load all required configuration parameters.
+     * @note Must be called before any of the getters.
+     */
+    bool load(void);
+
+    /// Get the state file, an empty string if the limiter is disabled.
+    const std::string & getStateFile(void) const;
+
+    /// Get the maximum fraction of time a GPIO pin may transmit.
+    double getDutyCycle(void) const;
+
+    /**
+     * @brief Get the period the duty cycle applies to.
+     * @note Unit: seconds
+     */
+    int32_t getPeriod(void) const;
+
+    /// Get the policy applied if the airtime budget is exhausted.
+    Policy::Policy_ getPolicy(void) const;
+
+private:
+    /// Reference of the related configuration instance.
+    const Configuration & configuration_;
+
+    /// State file, an empty string if the limiter is disabled.
+    std::string stateFile_;
+
+    /// Maximum fraction of time a GPIO pin may transmit.
+    double dutyCycle_;
+
+    /**
+     * @brief Period the duty cycle applies to.
+     * @note Unit: seconds
+     */
+    int32_t periodS_;
+
+    /// Policy applied if the airtime budget is exhausted.
+    Policy::Policy_ policy_;
+
+    /// Load the optional state file parameter from the configuration.
+    bool loadStateFile(void);
+
+    /// Load the duty cycle parameter from the configuration.
+    bool loadDutyCycle(void);
+
+    /// Load the optional period parameter from the configuration.
+    bool loadPeriod(void);
+
+    /// Load the optional policy parameter from the configuration.
+    bool loadPolicy(void);
+};
@@ -0,0 +1,81 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Configuration.h"
+#include "Task.h"
+#include "Types.h"
+
+/// Class responsible for benchmarking the processing of air scan dumps.
+class Benchmark : public Task {
+public:
+    /// Class constructor.
+    Benchmark(Configuration & configuration, const std::string & dumpFile,
+        const std::string & outputFile);
+
+    /// Start the benchmark.
+    int start(void) final;
+
+private:
+    /// Maximum number of samples the run detection is benchmarked with.
+    static const size_t MAX_DETECTION_SAMPLES = 64U * 1024U * 1024U;
+
+    /// File name of the air scan dump to be benchmarked with.
+    const std::string dumpFile_;
+
+    /// File name of the compressed dump or empty string to discard it.
+    const std::string outputFile_;
+
+    /**
+     * @brief Delay between two dump samples.
+     * @note Unit: microseconds
+     */
+    int32_t samplingRateUs_;
+
+    /// Runs of the air scan dump.
+    std::vector<Types::Run> runs_;
+
+    /// Load the air scan dump, measuring the time required for decoding.
+    bool loadDump(uint64_t & durationUs);
+
+    /// Benchmark the conversion of samples to runs.
+    bool benchmarkRunDetection(void) const;
+
+    /// Benchmark the sequential and the parallel dump analysis.
+    bool benchmarkAnalysis(void) const;
+
+    /// Benchmark the dump compression and decompression.
+    bool benchmarkCompression(void) const;
+
+    /// Check whether the given runs are identical.
+    static bool isEqual(const std::vector<Types::Run> & a,
+        const std::vector<Types::Run> & b);
+
+    /// Get the size of the given file.
+    static uint64_t getFileSize(const std::string & fileName);
+
+    /// Get the throughput in megabytes per second.
+    static double getThroughput(const uint64_t bytes,
+        const uint64_t durationUs);
+};
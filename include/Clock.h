@@ -0,0 +1,45 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/// Class providing a monotonic time base for timing critical loops.
+class Clock {
+public:
+    /**
+     * @brief Get the current monotonic time.
+     * @note Unit: microseconds
+     */
+    static uint64_t now(void);
+
+    /**
+     * @brief Sleep until the given absolute monotonic time has been reached.
+     * @note Unit: microseconds
+     */
+    static void sleepUntil(const uint64_t timeUs);
+
+private:
+    /// Number of microseconds per second.
+    static const uint64_t MICROSECONDS_PER_SECOND = 1000000U;
+
+    /// Number of nanoseconds per microsecond.
+    static const uint64_t NANOSECONDS_PER_MICROSECOND = 1000U;
+};
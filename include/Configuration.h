@@ -22,6 +22,7 @@
 #include <cassert>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include <libconfig.h++>
 
@@ -34,12 +35,22 @@ public:
     /// Set the absolute configuration file location.
     void setLocation(const std::string & location);
 
+    /// Get the configuration file location.
+    const std::string & getLocation(void) const;
+
     /// Load the configuration file.
     bool load(void);
 
     /// Check whether the given section exists.
     bool isValidSection(const std::string section) const;
 
+    /// Get the names of all sections.
+    std::vector<std::string> getSections(void) const;
+
+    /// Get the requested configuration setting, e.g. a group or a list.
+    const libconfig::Setting * getSetting(const std::string section,
+        const std::string name) const;
+
     /**
      * @brief Get the requested configuration value.
      * @tparam T Type of the value.
@@ -0,0 +1,134 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Configuration.h"
+#include "DumpWriter.h"
+#include "Task.h"
+#include "Types.h"
+
+/**
+ * @brief Class generating synthetic air scan dumps.
+ *
+ * Random air commands of the built-in air codes are encoded and repeated like
+ * by targets, separated by silence gaps. Edge jitter, glitches within pulses
+ * and noise pulses within the gaps can be injected. The dump only depends on
+ * the settings and the seed, i.e. it is reproducible on any machine.
+ */
+class Corpus : public Task {
+public:
+    /// Class constructor.
+    Corpus(Configuration & configuration, const uint32_t sizeMb,
+        const std::string & dumpFile, const int32_t samplingRateUs);
+
+    /// Set the generator settings given as name=value arguments.
+    bool setArguments(const std::vector<std::string> & arguments) final;
+
+    /// Start the generation.
+    int start(void) final;
+
+private:
+    /// Generator setting.
+    struct Setting {
+        /// Name of the setting.
+        const char * name;
+
+        /// Default value.
+        int32_t defaultValue;
+
+        /// Minimum value.
+        int32_t minimum;
+
+        /// Maximum value.
+        int32_t maximum;
+    };
+
+    /// Number of generator settings.
+    static const size_t SETTING_COUNT = 11U;
+
+    /// Generator settings.
+    static const Setting SETTINGS[SETTING_COUNT];
+
+    /// Number of samples per megabyte of a raw dump.
+    static const uint64_t SAMPLES_PER_MB = 1024U * 1024U;
+
+    /// Number of samples to be generated.
+    const uint64_t totalSamples_;
+
+    /// File name of the air scan dump.
+    const std::string dumpFile_;
+
+    /**
+     * @brief Delay between two samples or Types::INVALID_PARAMETER to use
+     *        the sampling rate of the air scan.
+     * @note Unit: microseconds
+     */
+    int32_t samplingRateUs_;
+
+    /// Values of all generator settings.
+    std::map<std::string, int32_t> settings_;
+
+    /// Random number generator, fully specified by the C++ standard.
+    std::mt19937 random_;
+
+    /// Writer of the air scan dump.
+    std::unique_ptr<DumpWriter> writer_;
+
+    /// Run of samples not written yet.
+    Types::Run run_;
+
+    /// Signal level at the end of the generated signal.
+    bool level_;
+
+    /// Number of samples generated.
+    uint64_t samples_;
+
+    /**
+     * @brief Time of the end of the generated signal.
+     * @note Unit: microseconds
+     */
+    uint64_t timeUs_;
+
+    /// Number of complete air command transmissions generated.
+    uint64_t frames_;
+
+    /// Get a random number within [0, range).
+    uint32_t getRandom(const uint32_t range);
+
+    /// Encode a random air command of the given air code.
+    std::vector<Types::Pulse> encode(const Types::AirCode::AirCode_ airCode);
+
+    /// Generate a single air command transmission.
+    bool transmit(const std::vector<Types::Pulse> & pulses);
+
+    /// Generate silence of the given duration, injecting noise pulses.
+    bool pause(const uint64_t durationUs);
+
+    /// Generate a pulse starting at the given intended time.
+    bool emit(const bool level, const uint64_t durationUs,
+        const uint64_t intendedUs);
+};
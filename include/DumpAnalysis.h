@@ -0,0 +1,224 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FrameDetector.h"
+#include "Types.h"
+
+/**
+ * @brief Class analyzing air scan dumps in parallel.
+ *
+ * The sample data is split into chunks which are read and analyzed by a pool
+ * of threads. Compressed dumps are split at run boundaries, the signal level
+ * of each chunk is derived from the number of runs preceding it. Runs and
+ * pulses crossing chunk boundaries as well as frames spanning them are
+ * stitched in chunk order, i.e. the results are identical to a sequential
+ * pass over the dump. Only the runs before the first and after the last
+ * silence gap of each chunk are kept for stitching, frames in between are
+ * detected by the thread analyzing the chunk.
+ */
+class DumpAnalysis {
+public:
+    /// Number of pulse width histogram buckets, one per power of two.
+    static const size_t HISTOGRAM_BUCKETS = 64U;
+
+    /// Statistics of an air scan dump.
+    struct Statistics {
+        /// Total number of samples.
+        uint64_t samples;
+
+        /// Number of high samples.
+        uint64_t highSamples;
+
+        /// Number of signal level transitions.
+        uint64_t edges;
+
+        /// Number of detected frames.
+        uint64_t frames;
+
+        /**
+         * @brief Number of high and low pulses per pulse width, bucket n
+         *        counts pulses lasting for [2^n, 2^(n+1)) microseconds.
+         */
+        std::array<std::array<uint64_t, HISTOGRAM_BUCKETS>, 2U> histogram;
+
+        /// Check whether both statistics are equal.
+        bool operator==(const Statistics & other) const;
+    };
+
+    /// Class constructor.
+    DumpAnalysis(const std::string & dumpFile, const int32_t frameGapUs);
+
+    /// Analyze the air scan dump with the given number of threads.
+    bool analyze(const uint32_t threads);
+
+    /// Check whether the dump file is compressed.
+    bool isCompressed(void) const;
+
+    /**
+     * @brief Get the delay between two dump samples.
+     * @note Unit: microseconds
+     */
+    int32_t getSamplingRate(void) const;
+
+    /// Get the statistics of the air scan dump.
+    const Statistics & getStatistics(void) const;
+
+private:
+    /// Pulse of consecutive runs sharing the same signal level.
+    struct Pulse {
+        /// Signal level, true for a high signal.
+        bool level;
+
+        /// Number of samples, 0 if there is no pulse.
+        uint64_t samples;
+    };
+
+    /// Chunk of the sample data and its partial results.
+    struct Chunk {
+        /// File offset of the first byte of the chunk.
+        uint64_t begin;
+
+        /// File offset behind the last byte of the chunk.
+        uint64_t end;
+
+        /// Number of compressed runs preceding the chunk.
+        uint64_t runs;
+
+        /// Flag to determine whether reading the chunk failed.
+        bool hasFailed;
+
+        /// Total number of samples.
+        uint64_t samples;
+
+        /// Number of high samples.
+        uint64_t highSamples;
+
+        /// First pulse, the only pulse of chunks without transitions.
+        Pulse first;
+
+        /// Last pulse, no pulse for chunks without transitions.
+        Pulse last;
+
+        /// Number of pulses between the first and the last pulse.
+        uint64_t pulses;
+
+        /// Pulse width histogram of the pulses between first and last.
+        std::array<std::array<uint64_t, HISTOGRAM_BUCKETS>, 2U> histogram;
+
+        /// Runs up to and including the first silence gap.
+        std::vector<Types::Run> head;
+
+        /// Flag to determine whether the head ends with a silence gap.
+        bool hasGap;
+
+        /// Number of frames between the first and the last silence gap.
+        uint64_t frames;
+
+        /// Runs after the last silence gap, without the last run.
+        std::vector<Types::Run> tail;
+
+        /// Last run, which may continue in the next chunk.
+        Types::Run lastRun;
+    };
+
+    /// Nominal size of a chunk (unit: bytes).
+    static const uint64_t CHUNK_SIZE = 1024U * 1024U;
+
+    /// Number of chunks analyzed per thread before stitching them.
+    static const size_t CHUNKS_PER_THREAD = 4U;
+
+    /// File name of the air scan dump.
+    const std::string dumpFile_;
+
+    /**
+     * @brief Minimum silence period separating two frames.
+     * @note Unit: microseconds
+     */
+    const int32_t frameGapUs_;
+
+    /// Flag to determine whether the dump file is compressed.
+    bool isCompressed_;
+
+    /**
+     * @brief Delay between two dump samples.
+     * @note Unit: microseconds
+     */
+    int32_t samplingRateUs_;
+
+    /// Minimum number of low samples separating two frames.
+    uint64_t gapSamples_;
+
+    /// Statistics of the air scan dump.
+    Statistics statistics_;
+
+    /// Frame detector for the runs stitched in chunk order.
+    std::unique_ptr<FrameDetector> detector_;
+
+    /// Run not yet added to the frame detector.
+    Types::Run run_;
+
+    /// Pulse not yet added to the histogram.
+    Pulse pulse_;
+
+    /// Number of pulses added to the histogram.
+    uint64_t pulses_;
+
+    /// Split the sample data into chunks.
+    bool split(const uint64_t dataOffset, const uint32_t threads,
+        std::vector<Chunk> & chunks) const;
+
+    /// Read and analyze the given chunk.
+    void analyzeChunk(Chunk & chunk) const;
+
+    /// Merge the results of the given chunk with the previous chunks.
+    void stitch(const Chunk & chunk);
+
+    /// Add the next run to the frame detector.
+    void addRun(const Types::Run & run);
+
+    /// Add the pending run to the frame detector.
+    void flushRun(void);
+
+    /// Add the given pulse to the given histogram.
+    void addPulse(const Pulse & pulse,
+        std::array<std::array<uint64_t, HISTOGRAM_BUCKETS>, 2U> & histogram)
+        const;
+
+    /// Check whether the given run is a silence gap.
+    bool isGap(const Types::Run & run) const;
+
+    /// Find the first compressed run boundary at or after the given offset.
+    uint64_t align(const uint64_t offset) const;
+
+    /// Count the compressed runs within the given range.
+    uint64_t countRuns(const uint64_t begin, const uint64_t end) const;
+
+    /// Execute the given work for all indexes with a pool of threads.
+    static void execute(const size_t count, const uint32_t threads,
+        const std::function<void(size_t)> & work);
+};
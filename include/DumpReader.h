@@ -0,0 +1,116 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Types.h"
+
+/**
+ * @brief Class reading air scan dump files.
+ *
+ * Both raw and compressed dumps are supported. The sample data is read
+ * block-wise and returned as runs of samples sharing the same signal level,
+ * i.e. dumps of any size can be processed in a streaming fashion.
+ */
+class DumpReader {
+public:
+    /// Class constructor.
+    DumpReader(const std::string & dumpFile);
+
+    /// Open the dump file and read its header.
+    bool open(void);
+
+    /// Restrict reading to the given range of the sample data.
+    bool seek(const uint64_t begin, const uint64_t end, const uint64_t runs);
+
+    /// Get the file offset of the sample data.
+    uint64_t getDataOffset(void) const;
+
+    /**
+     * @brief Get the delay between two dump samples.
+     * @note Unit: microseconds
+     */
+    int32_t getSamplingRate(void) const;
+
+    /// Check whether the dump file is compressed.
+    bool isCompressed(void) const;
+
+    /// Read the next run of samples.
+    bool read(Types::Run & run);
+
+    /// Check whether reading failed due to an error.
+    bool hasFailed(void) const;
+
+private:
+    /// Size of the read buffer.
+    static const size_t BLOCK_SIZE = 64U * 1024U;
+
+    /// File name of the air scan dump.
+    const std::string dumpFileName_;
+
+    /// Air scan dump file.
+    std::ifstream dumpFile_;
+
+    /// Read buffer.
+    std::vector<char> buffer_;
+
+    /// Position of the next unread byte within the read buffer.
+    size_t position_;
+
+    /// Number of valid bytes within the read buffer.
+    size_t size_;
+
+    /// Number of bytes left to be read from the dump file.
+    uint64_t remaining_;
+
+    /// File offset of the sample data.
+    uint64_t dataOffset_;
+
+    /**
+     * @brief Delay between two dump samples.
+     * @note Unit: microseconds
+     */
+    int32_t samplingRateUs_;
+
+    /// Flag to determine whether the dump file is compressed.
+    bool isCompressed_;
+
+    /// Signal level of the first compressed run.
+    bool firstLevel_;
+
+    /// Signal level of the next compressed run.
+    bool level_;
+
+    /// Flag to determine whether reading failed due to an error.
+    bool hasFailed_;
+
+    /// Refill the read buffer if it has been consumed completely.
+    bool fill(void);
+
+    /// Read the next run of a raw dump file.
+    bool readRaw(Types::Run & run);
+
+    /// Read the next run of a compressed dump file.
+    bool readCompressed(Types::Run & run);
+};
@@ -0,0 +1,77 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Types.h"
+
+/**
+ * @brief Class writing air scan dump files.
+ *
+ * Compressed dumps store the sample data as alternating runs of low and high
+ * samples, each encoded as variable length integer. Long runs of constant
+ * signal levels therefore shrink to a few bytes.
+ */
+class DumpWriter {
+public:
+    /// Class constructor.
+    DumpWriter(const std::string & dumpFile, const bool compress);
+
+    /// Create the dump file and write its header.
+    bool open(const int32_t samplingRateUs);
+
+    /// Write a run of samples.
+    bool write(const Types::Run & run);
+
+    /// Write all buffered data to the dump file.
+    bool close(void);
+
+private:
+    /// Size of the write buffer.
+    static const size_t BLOCK_SIZE = 64U * 1024U;
+
+    /// File name of the air scan dump.
+    const std::string dumpFileName_;
+
+    /// Flag to determine whether the dump file will be compressed.
+    const bool compress_;
+
+    /// Air scan dump file.
+    std::ofstream dumpFile_;
+
+    /// Write buffer.
+    std::vector<char> buffer_;
+
+    /// Flag to determine whether a run has been written already.
+    bool hasRuns_;
+
+    /// Signal level of the previously written run.
+    bool level_;
+
+    /// Write the buffered data to the dump file.
+    bool flush(void);
+
+    /// Append a variable length integer to the write buffer.
+    void appendVarint(uint32_t value);
+};
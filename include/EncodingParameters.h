@@ -0,0 +1,91 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Configuration.h"
+
+/**
+ * @brief Class holding a custom encoding defined in the 'encodings' section.
+ *
+ * Each symbol is defined by its air command character and a sequence of
+ * segments, i.e. signal levels held for a fraction of either the data or
+ * the sync element length.
+ */
+class EncodingParameters {
+public:
+    /// Segment of a symbol, i.e. a constant signal level.
+    struct Segment {
+        /// Signal level, true for a high signal.
+        bool level;
+
+        /// Fraction of the element length.
+        double fraction;
+    };
+
+    /// Symbol of an air command.
+    struct Symbol {
+        /// Air command character.
+        char character;
+
+        /// True if the fractions refer to the sync element length.
+        bool isSync;
+
+        /// Segments of the symbol.
+        std::vector<Segment> segments;
+    };
+
+    /// Class constructor.
+    EncodingParameters(const Configuration & configuration,
+        const std::string & name);
+
+    /**
+     * @brief Load all required configuration parameters.
+     * @note Must be called before any of the getters.
+     */
+    bool load(void);
+
+    /// Get the name of the encoding.
+    const std::string & getName(void) const;
+
+    /// Get the symbols of the encoding.
+    const std::vector<Symbol> & getSymbols(void) const;
+
+    /// Get all characters allowed in air commands of the encoding.
+    std::string getAlphabet(void) const;
+
+private:
+    /// Reference of the related configuration instance.
+    const Configuration & configuration_;
+
+    /// Name of the encoding.
+    const std::string name_;
+
+    /// Symbols of the encoding.
+    std::vector<Symbol> symbols_;
+
+    /// Load the symbols from the configuration.
+    bool loadSymbols(void);
+
+    /// Load a single symbol from the configuration.
+    bool loadSymbol(const libconfig::Setting & setting);
+};
@@ -0,0 +1,109 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include "FrameDetector.h"
+#include "TargetIndex.h"
+#include "Types.h"
+
+/**
+ * @brief Class collapsing repeated radio frames within a stream of runs.
+ *
+ * Remotes transmit the same frame several times per button press. Each frame
+ * detected by FrameDetector is reduced to its pulse sequence and looked up by
+ * its signature. Frames matching a previous frame within the pulse tolerance
+ * are counted as repeats of it, so only unique frames are kept along with
+ * their repeat count and the time of their first and last reception.
+ */
+class FrameDeduplicator {
+public:
+    /// Class constructor.
+    FrameDeduplicator(const int32_t samplingRateUs, const int32_t frameGapUs);
+
+    /// Add the next run of the stream.
+    void add(const Types::Run & run);
+
+    /// Complete the stream.
+    void finish(void);
+
+    /// Print the unique frames, identified by the given target index.
+    void print(std::ostream & stream,
+        const TargetIndex * targetIndex = nullptr) const;
+
+private:
+    /// Unique frame.
+    struct Entry {
+        /// Pulses of the first reception.
+        std::vector<Types::Pulse> pulses;
+
+        /// Number of receptions.
+        uint32_t repeats;
+
+        /**
+         * @brief Offset of the first reception within the stream.
+         * @note Unit: microseconds
+         */
+        uint64_t firstUs;
+
+        /**
+         * @brief Offset of the last reception within the stream.
+         * @note Unit: microseconds
+         */
+        uint64_t lastUs;
+    };
+
+    /**
+     * @brief Delay between two samples.
+     * @note Unit: microseconds
+     */
+    const int32_t samplingRateUs_;
+
+    /// Minimum number of low samples separating two frames.
+    const uint64_t gapSamples_;
+
+    /// Frame detector.
+    FrameDetector detector_;
+
+    /// Position of the next run within the stream.
+    uint64_t position_;
+
+    /// Position of the first pending run within the stream.
+    uint64_t pendingStart_;
+
+    /// Runs since the last silence gap.
+    std::vector<Types::Run> pending_;
+
+    /// Unique frames in order of their first reception.
+    std::vector<Entry> entries_;
+
+    /// Unique frames by signature of their pulse sequence.
+    std::unordered_map<uint64_t, size_t> hashes_;
+
+    /// Total number of frames.
+    uint64_t frames_;
+
+    /// Add the given frame of the pending runs.
+    void addFrame(const Types::Frame & frame);
+};
@@ -0,0 +1,60 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "Types.h"
+
+/**
+ * @brief Class detecting radio frames within a stream of runs.
+ *
+ * Frames are separated by silence gaps, i.e. low signals lasting for at least
+ * the frame gap. A frame starts with the first high signal after a silence
+ * gap and ends with the beginning of the next silence gap (or the end of the
+ * stream). Frames consisting of only a few runs are considered noise.
+ */
+class FrameDetector {
+public:
+    /// Class constructor.
+    FrameDetector(const int32_t samplingRateUs, const int32_t frameGapUs);
+
+    /// Add the next run, returns true if a frame has been completed.
+    bool add(const Types::Run & run, Types::Frame & frame);
+
+    /// Complete the stream, returns true if a frame has been completed.
+    bool finish(Types::Frame & frame);
+
+private:
+    /// Minimum number of runs a frame consists of, shorter frames are noise.
+    static const uint32_t MIN_FRAME_RUNS = 8U;
+
+    /// Minimum number of low samples separating two frames.
+    const uint64_t gapSamples_;
+
+    /// Position of the next run within the stream.
+    uint64_t position_;
+
+    /// Position of the current frame within the stream.
+    uint64_t frameStart_;
+
+    /// Number of runs of the current frame, 0 if there is no current frame.
+    uint32_t frameRuns_;
+};
@@ -0,0 +1,102 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Types.h"
+
+/**
+ * @brief Class maintaining the frame index of air scan dumps.
+ *
+ * The frames detected by FrameDetector are stored in a sidecar index file
+ * next to the dump so that subsequent replays do not need to analyze the dump
+ * again.
+ */
+class FrameIndex {
+public:
+    /// Class constructor.
+    FrameIndex(const std::string & dumpFile, const int32_t samplingRateUs,
+        const int32_t frameGapUs);
+
+    /**
+     * @brief Load the frames from the sidecar index file, detect and store
+     *        them if the index file is missing or outdated.
+     */
+    void update(const std::vector<Types::Run> & runs);
+
+    /// Get the detected frames.
+    const std::vector<Types::Frame> & getFrames(void) const;
+
+    /// Detect the frames within the given runs.
+    static std::vector<Types::Frame> detect(const std::vector<Types::Run> & runs,
+        const int32_t samplingRateUs, const int32_t frameGapUs);
+
+private:
+    /// File name extension of the sidecar index file.
+    static const std::string FILE_EXTENSION;
+
+    /// File name of the sidecar index file.
+    const std::string indexFile_;
+
+    /// File name of the related air scan dump.
+    const std::string dumpFile_;
+
+    /**
+     * @brief Delay between two dump samples.
+     * @note Unit: microseconds
+     */
+    const int32_t samplingRateUs_;
+
+    /**
+     * @brief Minimum silence period separating two frames.
+     * @note Unit: microseconds
+     */
+    const int32_t frameGapUs_;
+
+    /// Detected frames.
+    std::vector<Types::Frame> frames_;
+
+    /// Status of the related air scan dump file the index is bound to.
+    struct DumpStatus {
+        /**
+         * @brief Size of the dump file.
+         * @note Unit: bytes
+         */
+        uint64_t size;
+
+        /**
+         * @brief Time of the last modification of the dump file.
+         * @note Unit: nanoseconds since the epoch
+         */
+        int64_t modifiedNs;
+    };
+
+    /// Get the status of the related air scan dump file.
+    DumpStatus getDumpStatus(void) const;
+
+    /// Load the frames from the sidecar index file.
+    bool load(void);
+
+    /// Store the frames to the sidecar index file.
+    bool save(void) const;
+};
@@ -0,0 +1,65 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Class writing several GPIO pins of the first bank at once.
+ *
+ * The GPIO registers are mapped from /dev/gpiomem, all pins set or cleared by
+ * a single write change their level at the same time. If the registers
+ * cannot be mapped the pins are written one after another using wiringPi.
+ */
+class GpioBank {
+public:
+    /// Class constructor.
+    GpioBank(void);
+
+    /// Class destructor.
+    ~GpioBank(void);
+
+    GpioBank(const GpioBank &) = delete;
+    GpioBank & operator=(const GpioBank &) = delete;
+
+    /// Check whether the GPIO registers are mapped.
+    bool isMapped(void) const;
+
+    /**
+     * @brief Set and clear the given pins.
+     * @param setMask Pins to be set to a high signal, bit n for GPIO pin n.
+     * @param clearMask Pins to be set to a low signal, bit n for GPIO pin n.
+     */
+    void write(const uint32_t setMask, const uint32_t clearMask) const;
+
+private:
+    /// Size of the GPIO register block.
+    static const size_t BLOCK_SIZE = 4096U;
+
+    /// Register index of the output set register of the first bank.
+    static const size_t GPSET0 = 7U;
+
+    /// Register index of the output clear register of the first bank.
+    static const size_t GPCLR0 = 10U;
+
+    /// Mapped GPIO registers or nullptr if not mapped.
+    volatile uint32_t * registers_;
+};
@@ -0,0 +1,73 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Configuration.h"
+
+/// Class holding all parameters of a group of targets.
+class GroupParameters {
+public:
+    /// Member of a group.
+    struct Member {
+        /// Target section name.
+        std::string name;
+
+        /**
+         * @brief Minimum low signal period before transmissions of the
+         *        member following transmissions of other targets.
+         * @note Unit: microseconds, Types::INVALID_PARAMETER for the default
+         */
+        int32_t gapUs;
+    };
+
+    /// Class constructor.
+    GroupParameters(const Configuration & configuration,
+        const std::string & name);
+
+    /// Check whether a group of the given name exists.
+    static bool isGroup(const Configuration & configuration,
+        const std::string & name);
+
+    /**
+     * @brief Load all required configuration parameters.
+     * @note Must be called before any of the getters.
+     */
+    bool load(void);
+
+    /// Get all members of the group.
+    const std::vector<Member> & getMembers(void) const;
+
+private:
+    /// Reference of the related configuration instance.
+    const Configuration & configuration_;
+
+    /// Group name.
+    const std::string name_;
+
+    /// Members of the group.
+    std::vector<Member> members_;
+
+    /// Load the members from the configuration.
+    bool loadMembers(void);
+};
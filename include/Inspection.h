@@ -0,0 +1,84 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Configuration.h"
+#include "DumpAnalysis.h"
+#include "ReplayParameters.h"
+#include "Task.h"
+#include "Types.h"
+
+/// Class responsible for inspecting air scan dumps.
+class Inspection : public Task {
+public:
+    /// Class constructor.
+    Inspection(Configuration & configuration, const std::string & dumpFile,
+        const Types::OutputFormat::OutputFormat_ outputFormat);
+
+    /// Start the inspection.
+    int start(void) final;
+
+private:
+    /// File name of the air scan dump.
+    const std::string dumpFile_;
+
+    /// Output format of the inspection results.
+    const Types::OutputFormat::OutputFormat_ outputFormat_;
+
+    /// Replay parameters, providing the frame gap.
+    std::unique_ptr<ReplayParameters> parameters_;
+
+    /// Flag to determine whether the dump file is compressed.
+    bool isCompressed_;
+
+    /**
+     * @brief Delay between two dump samples.
+     * @note Unit: microseconds
+     */
+    int32_t samplingRateUs_;
+
+    /// Statistics of the air scan dump.
+    DumpAnalysis::Statistics statistics_;
+
+    /// Collect all statistics of the air scan dump.
+    bool inspect(void);
+
+    /// Learn a target section from the air scan dump and print it.
+    bool learn(void) const;
+
+    /// Print the unique frames of the air scan dump, identified on request.
+    bool deduplicate(void) const;
+
+    /// Print the inspection results as human readable text.
+    void printText(void) const;
+
+    /// Print the inspection results as JSON object.
+    void printJson(void) const;
+
+    /// Get the duty cycle.
+    double getDutyCycle(void) const;
+
+    /// Escape the given string for JSON output.
+    static std::string escapeJson(const std::string & value);
+};
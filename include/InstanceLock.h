@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 /**
@@ -26,7 +27,7 @@
  *
  * A lock file will be created. If another program instance is started in
  * parallel (and the lock file exists) the class will block execution until the
- * lock file has been removed (which is done at program exit automatically).
+ * lock has been released (which is done at program exit automatically).
  * This will prevent accessing shared resources by multiple instances.
  */
 class InstanceLock {
@@ -34,10 +35,37 @@ public:
     /// Create a lock.
     static void lock(void);
 
+    /// Create a lock unless another program instance holds it.
+    static bool tryLock(void);
+
+    /// Release the lock.
+    static void unlock(void);
+
+    /**
+     * @brief Get the period waited for the lock.
+     * @note Unit: microseconds
+     */
+    static uint64_t getWaitTime(void);
+
 private:
     /// Absolute path of the lock file.
     static const std::string LOCK_FILE;
 
-    /// Release the lock.
-    static void unlock(void);
+    /**
+     * @brief Period waited for the lock.
+     * @note Unit: microseconds
+     */
+    static uint64_t waitUs_;
+
+    /// Descriptor of the lock file or -1 if not opened.
+    static int fd_;
+
+    /// True if the lock is held by this program instance.
+    static bool isLocked_;
+
+    /// Open the lock file.
+    static void open(void);
+
+    /// Set the lock of the lock file.
+    static bool setLock(const short type);
 };
@@ -0,0 +1,214 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "AirCodeTraits.h"
+#include "Types.h"
+
+/**
+ * @brief Class learning target parameters from air scan data.
+ *
+ * The radio frames of the air scan data are decoded with all supported
+ * encodings. The most frequently received frame is converted to the
+ * parameters of a target section, i.e. encoding, air command, pulse lengths,
+ * number of repetitions and the delay between them.
+ */
+class Learner {
+public:
+    /// Class constructor.
+    Learner(const int32_t samplingRateUs, const int32_t frameGapUs);
+
+    /// Add the next run of the air scan data.
+    void add(const Types::Run & run);
+
+    /// Learn the target parameters from all runs added.
+    bool learn(void);
+
+    /// Print the learned target section.
+    void print(std::ostream & stream, const std::string & name) const;
+
+    /// Get the learned radio frame encoding type.
+    Types::AirCode::AirCode_ getAirCode(void) const;
+
+    /// Get the learned air command.
+    const std::string & getAirCommand(void) const;
+
+    /// Get the number of frames received with the learned air command.
+    int32_t getFrames(void) const;
+
+private:
+    /// Single pulse of a radio frame.
+    struct Pulse {
+        /// Signal level, true for a high signal.
+        bool level;
+
+        /**
+         * @brief Pulse duration.
+         * @note Unit: microseconds
+         */
+        double durationUs;
+    };
+
+    /// Sums of the least squares fit of the element lengths.
+    struct Fit {
+        /// Sum of the squared data element counts.
+        double dataData = 0.0;
+
+        /// Sum of the products of data and sync element counts.
+        double dataSync = 0.0;
+
+        /// Sum of the squared sync element counts.
+        double syncSync = 0.0;
+
+        /// Sum of the products of data element counts and durations.
+        double dataDuration = 0.0;
+
+        /// Sum of the products of sync element counts and durations.
+        double syncDuration = 0.0;
+
+        /// Add a pulse consisting of the given number of elements.
+        void add(const double data, const double sync,
+            const double durationUs);
+
+        /// Solve the fit for the element lengths.
+        void solve(double & dataLengthUs, double & syncLengthUs) const;
+    };
+
+    /// Result of decoding a single frame.
+    struct Decoding {
+        /// Radio frame encoding type.
+        Types::AirCode::AirCode_ airCode;
+
+        /// Decoded air command.
+        std::string airCommand;
+
+        /**
+         * @brief Pulse length of a single data element.
+         * @note Unit: microseconds
+         */
+        double dataLengthUs;
+
+        /**
+         * @brief Pulse length of a single sync element.
+         * @note Unit: microseconds
+         */
+        double syncLengthUs;
+
+        /**
+         * @brief Low signal of the first and last symbol hidden in the
+         *        silence gaps around the frame.
+         * @note Unit: microseconds
+         */
+        double hiddenUs;
+
+        /// Timing error relative to the frame duration.
+        double error;
+
+        /// Shortest segment of the encoding (unit: microseconds).
+        double shortestUs;
+
+        /// Fit of the element lengths to the decoded pulses.
+        Fit fit;
+    };
+
+    /// Position within the pulses while decoding.
+    struct Cursor {
+        /// Index of the current pulse.
+        size_t pulse;
+
+        /// Remaining duration of the current pulse (unit: microseconds).
+        double remainingUs;
+
+        /// Accumulated timing error (unit: microseconds).
+        double errorUs;
+
+        /// Duration hidden in the silence gaps (unit: microseconds).
+        double hiddenUs;
+
+        /// Duration of the decoded symbols (unit: microseconds).
+        double frameUs;
+
+        /// Data elements consumed from the current pulse (unit: twelfths).
+        uint32_t dataTwelfths;
+
+        /// Sync elements consumed from the current pulse (unit: twelfths).
+        uint32_t syncTwelfths;
+
+        /// Fit of the element lengths to the consumed pulses.
+        Fit fit;
+    };
+
+    /// Maximum number of frames to be decoded.
+    static const size_t MAX_FRAMES = 256U;
+
+    /**
+     * @brief Delay between two samples.
+     * @note Unit: microseconds
+     */
+    const int32_t samplingRateUs_;
+
+    /**
+     * @brief Minimum silence period separating two frames.
+     * @note Unit: microseconds
+     */
+    const int32_t frameGapUs_;
+
+    /// Runs of the air scan data.
+    std::vector<Types::Run> runs_;
+
+    /// Learned frame.
+    Decoding learned_;
+
+    /// Number of frames received with the learned air command.
+    int32_t frames_;
+
+    /// Number of air command repetitions.
+    int32_t sendCommand_;
+
+    /**
+     * @brief Delay between repeated air command transmissions.
+     * @note Unit: microseconds
+     */
+    int32_t sendDelayUs_;
+
+    /// Get the pulses of the given frame.
+    std::vector<Pulse> getPulses(const Types::Frame & frame) const;
+
+    /// Decode the given pulses with the best matching encoding.
+    bool findDecoding(const std::vector<Pulse> & pulses, Decoding & best)
+        const;
+
+    /// Decode the given pulses with the given encoding and element lengths.
+    bool decode(const std::vector<Pulse> & pulses, Decoding & decoding)
+        const;
+
+    /// Decode the remaining pulses starting at the given cursor.
+    bool decode(const std::vector<Pulse> & pulses, Decoding & decoding,
+        const Cursor & cursor, uint32_t & budget) const;
+
+    /// Match a symbol against the pulses at the given cursor.
+    bool match(const std::vector<Pulse> & pulses, const Decoding & decoding,
+        const AirSymbol & symbol, Cursor & cursor) const;
+};
@@ -0,0 +1,101 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Task.h"
+
+/**
+ * @brief Class maintaining metrics in the Prometheus text format.
+ *
+ * The metrics of a single program invocation are merged into the metrics
+ * text file, i.e. all counters and histograms accumulate across invocations.
+ * The file is replaced atomically, concurrent invocations are serialized by
+ * a lock file. The text file is intended for the node_exporter textfile
+ * collector.
+ */
+class Metrics {
+public:
+    /// Class constructor.
+    explicit Metrics(const std::string & textFile);
+
+    /// Add the metrics of a completed task.
+    void addTask(const std::string & type, const std::string & name,
+        const Task::Timing & timing, const uint64_t startUs,
+        const uint64_t endUs, const bool isSuccess);
+
+    /// Add the period waited for the instance lock.
+    void addLockWait(const std::string & type, const uint64_t waitUs);
+
+    /// Merge the metrics into the metrics text file.
+    bool write(void) const;
+
+private:
+    /// Metric family, i.e. all series sharing the same metric name.
+    struct Family {
+        /// Help text.
+        std::string help;
+
+        /// Metric type, either "counter" or "histogram".
+        std::string type;
+
+        /// Series keys (name and labels) in order of appearance.
+        std::vector<std::string> series;
+    };
+
+    /// Upper bounds of the histogram buckets (unit: seconds).
+    static const std::vector<double> BUCKETS;
+
+    /// Metrics text file.
+    const std::string textFile_;
+
+    /// Metric families by name.
+    std::map<std::string, Family> families_;
+
+    /// Values by series key.
+    std::map<std::string, double> values_;
+
+    /// Get the label set of the given labels.
+    static std::string getLabels(
+        const std::vector<std::pair<std::string, std::string>> & labels);
+
+    /// Add a value to a series of the given family.
+    void add(const std::string & name, const std::string & help,
+        const std::string & type, const std::string & key,
+        const double value);
+
+    /// Add a value to a counter.
+    void addCounter(const std::string & name, const std::string & help,
+        const std::string & labels, const double value);
+
+    /// Add an observation to a histogram.
+    void addHistogram(const std::string & name, const std::string & help,
+        const std::string & labels, const double value);
+
+    /// Read the metrics from the metrics text file.
+    bool read(void);
+
+    /// Save the metrics to the metrics text file.
+    bool save(void) const;
+};
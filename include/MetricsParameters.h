@@ -0,0 +1,50 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "Configuration.h"
+
+/// Class holding all parameters required for metrics.
+class MetricsParameters {
+public:
+    /// Class constructor.
+    MetricsParameters(const Configuration & configuration);
+
+    /**
+     * @brief Load all required configuration parameters.
+     * @note Must be called before any of the getters.
+     */
+    bool load(void);
+
+    /// Get the metrics text file, an empty string if metrics are disabled.
+    const std::string & getTextFile(void) const;
+
+private:
+    /// Reference of the related configuration instance.
+    const Configuration & configuration_;
+
+    /// Metrics text file, an empty string if metrics are disabled.
+    std::string textFile_;
+
+    /// Load the optional text file parameter from the configuration.
+    bool loadTextFile(void);
+};
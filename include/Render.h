@@ -0,0 +1,70 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Configuration.h"
+#include "Target.h"
+#include "Task.h"
+#include "Types.h"
+
+/**
+ * @brief Class responsible for rendering targets to air scan dumps.
+ *
+ * The target is encoded like for a transmission, including all repetitions
+ * and the delays between them, and sampled at the given sampling rate. The
+ * waveform is surrounded by silence gaps and written to an air scan dump, the
+ * GPIO pins are not accessed.
+ */
+class Render : public Task {
+public:
+    /// Class constructor.
+    Render(Configuration & configuration, const std::string & name,
+        const std::string & dumpFile, const int32_t samplingRateUs);
+
+    /// Set the template variables of the target.
+    bool setArguments(const std::vector<std::string> & arguments) final;
+
+    /// Start the rendering.
+    int start(void) final;
+
+private:
+    /// Target to be rendered.
+    std::unique_ptr<Target> target_;
+
+    /// File name of the air scan dump.
+    const std::string dumpFile_;
+
+    /**
+     * @brief Delay between two samples or Types::INVALID_PARAMETER to use
+     *        the sampling rate of the air scan.
+     * @note Unit: microseconds
+     */
+    const int32_t samplingRateUs_;
+
+    /// Sample the given edges, surrounded by the given silence gap.
+    static std::vector<Types::Run> sample(
+        const std::vector<Types::Edge> & edges, const uint64_t gapUs,
+        const int32_t samplingRateUs);
+};
@@ -26,12 +26,14 @@
 #include "Configuration.h"
 #include "ReplayParameters.h"
 #include "Task.h"
+#include "Types.h"
 
 /// Class responsible for replaying air scan dumps.
 class Replay : public Task {
 public:
     /// Class constructor.
-    Replay(Configuration & configuration, const std::string & dumpFile);
+    Replay(Configuration & configuration, const std::string & dumpFile,
+        const int32_t frame, const int32_t repeat, const int32_t repeatGapUs);
 
     /// Start replaying the air dump scan.
     int start(void) final;
@@ -40,6 +42,19 @@ private:
     /// File name of the air scan dump.
     const std::string dumpFile_;
 
+    /// Number of the frame to be replayed (starting at 1), 0 for all data.
+    const int32_t frame_;
+
+    /// Number of times the replay will be repeated.
+    const int32_t repeat_;
+
+    /**
+     * @brief Delay between repeated replays, the frame gap is used if the
+     *        value is invalid.
+     * @note Unit: microseconds
+     */
+    const int32_t repeatGapUs_;
+
     /// Replay parameters.
     std::unique_ptr<ReplayParameters> parameters_;
 
@@ -50,14 +65,20 @@ private:
     int32_t samplingRateUs_;
 
     /**
-     * @brief Storage for the air scan dump data. A false element indicates a
-     *        low signal, a true element a high signal.
+     * @brief Storage for the air scan dump data, compressed to runs of
+     *        samples sharing the same signal level.
      */
-    std::vector<bool> data_;
+    std::vector<Types::Run> runs_;
 
-    /// Perform the air scan replay based on the values stored in 'data_'.
+    /// Get the duration of a single replay of the runs stored in 'runs_'.
+    uint64_t getDuration(void) const;
+
+    /// Perform the air scan replay based on the runs stored in 'runs_'.
     void airReplay(void) const;
 
+    /// Reduce the runs stored in 'runs_' to the selected frame.
+    bool selectFrame(void);
+
     /// Deserialize the air scan dump data from the dump file.
     bool deserializeData(void);
 };
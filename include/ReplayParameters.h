@@ -38,13 +38,34 @@ public:
     /// Get the GPIO pin.
     uint8_t getGpioPin(void) const;
 
+    /**
+     * @brief Get the minimum silence period separating two frames.
+     * @note Unit: microseconds
+     */
+    int32_t getFrameGap(void) const;
+
 private:
+    /**
+     * @brief Frame gap used if not configured.
+     * @note Unit: microseconds
+     */
+    static const int32_t DEFAULT_FRAME_GAP_US = 8000;
+
     /// Configuration data.
     const Configuration & configuration_;
 
     /// GPIO pin.
     uint8_t gpioPin_;
 
+    /**
+     * @brief Minimum silence period separating two frames.
+     * @note Unit: microseconds
+     */
+    int32_t frameGapUs_;
+
     /// Load the GPIO pin from the configuration.
     bool loadGpioPin(void);
+
+    /// Load the optional frame gap parameter from the configuration.
+    bool loadFrameGap(void);
 };
@@ -0,0 +1,246 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+/**
+ * @brief Class combining concurrent program instances transmitting targets.
+ *
+ * The program instance holding the instance lock acts as leader. Other
+ * instances enqueue their request to a ring in shared memory and block on a
+ * futex until the leader has executed it, i.e. they neither poll the
+ * instance lock nor load the configuration. Identical pending requests are
+ * executed once. The ring is only modified while holding a file lock, which
+ * is released if its holder terminates, so a terminated instance never
+ * leaves the ring inconsistent.
+ */
+class RequestRing {
+public:
+    /// Request to transmit targets.
+    struct Request {
+        /**
+         * @brief Absolute configuration file location, only compared to the
+         *        location of the leader.
+         */
+        std::string configuration;
+
+        /// GPIO pin overriding the configuration.
+        uint8_t gpioPin;
+
+        /// Names of the targets.
+        std::vector<std::string> targets;
+
+        /// Template variables of the targets.
+        std::vector<std::string> arguments;
+
+        /**
+         * @brief Start time of the requesting program instance.
+         * @note Unit: microseconds
+         */
+        uint64_t startUs;
+    };
+
+    /// Function executing a request and returning the program exit code.
+    typedef std::function<int(const Request & request)> Executor;
+
+    /// Class constructor.
+    RequestRing(const std::string & configuration, const Executor & executor);
+
+    /// Class destructor.
+    ~RequestRing(void);
+
+    /// Map the ring from shared memory.
+    bool open(void);
+
+    /// Enqueue the given request and wait until it has been executed.
+    bool submit(const Request & request, int & exitCode);
+
+    /// Execute all pending requests while holding the instance lock.
+    void lead(void);
+
+private:
+    /// Runtime directory of the ring file for instances running as root.
+    static const std::string RUNTIME_DIRECTORY;
+
+    /// Runtime directory of the ring file for other users, plus the user ID.
+    static const std::string USER_RUNTIME_DIRECTORY;
+
+    /// Name of the file backing the shared memory.
+    static const std::string RING_FILE;
+
+    /// Identifier of the ring layout.
+    static const uint32_t MAGIC = 0x52434102U;
+
+    /// Number of slots.
+    static const uint32_t SLOTS = 64U;
+
+    /// Maximum size of a serialized request.
+    static const uint32_t REQUEST_SIZE = 2048U;
+
+    /**
+     * @brief Period after which a waiting instance checks for the leader.
+     * @note Unit: milliseconds
+     */
+    static const uint32_t WAIT_TIMEOUT_MS = 1000U;
+
+    /**
+     * @brief Period after which a waiting instance withdraws its request if
+     *        the leader has not started to execute it.
+     * @note Unit: milliseconds
+     */
+    static const uint32_t WAIT_LIMIT_MS = 10000U;
+
+    /// States of a slot.
+    struct State {
+        /// States of a slot.
+        enum State_ {
+            FREE = 0,
+            QUEUED = 1,
+            ACTIVE = 2,
+            CANCELLED = 3
+        };
+    };
+
+    /// Results of a request reported to the waiting instance.
+    struct Result {
+        /// Results of a request reported to the waiting instance.
+        enum Result_ {
+            SUCCESS = 0,
+            FAILURE = 1,
+            REJECTED = 2
+        };
+    };
+
+    /// Slot holding a single request.
+    struct Slot {
+        /**
+         * @brief Futex word of the completion, the ticket plus one shifted
+         *        left by two, the lowest bits holding the result.
+         */
+        std::atomic<uint32_t> completion;
+
+        /// State of the slot, zeroed memory is a free slot.
+        uint32_t state;
+
+        /// Ticket of the request.
+        uint32_t ticket;
+
+        /// Process ID of the leader executing the request.
+        pid_t leader;
+
+        /// Start time of the requesting program instance.
+        uint64_t startUs;
+
+        /// Size of the serialized request.
+        uint32_t size;
+
+        /// Serialized request.
+        char data[REQUEST_SIZE];
+    };
+
+    /// Layout of the shared memory.
+    struct Ring {
+        /// Identifier of the ring layout, zero if not initialized yet.
+        uint32_t magic;
+
+        /// Ticket of the next request to be enqueued.
+        uint32_t head;
+
+        /// Ticket of the next request to be dequeued.
+        uint32_t tail;
+
+        /// Slots of the requests.
+        Slot slots[SLOTS];
+    };
+
+    /// Request dequeued by the leader.
+    struct Pending {
+        /// Ticket of the request.
+        uint32_t ticket;
+
+        /// Start time of the requesting program instance.
+        uint64_t startUs;
+
+        /// Serialized request.
+        std::string data;
+    };
+
+    /// Absolute configuration file location of this program instance.
+    const std::string configuration_;
+
+    /// Function executing a request.
+    const Executor executor_;
+
+    /// Descriptor of the ring file or -1 if not opened.
+    int fd_;
+
+    /// Shared memory or nullptr if not mapped.
+    Ring * ring_;
+
+    /// Get the location of the ring file within a trusted directory.
+    static bool getRingFile(std::string & ringFile);
+
+    /// Lock the ring file, serializing all modifications of the ring.
+    void lockRing(void) const;
+
+    /// Unlock the ring file.
+    void unlockRing(void) const;
+
+    /// Enqueue the given serialized request.
+    bool enqueue(const std::string & data, const uint64_t startUs,
+        uint32_t & ticket);
+
+    /// Dequeue all queued requests.
+    void dequeue(std::vector<Pending> & pendings);
+
+    /// Reject all requests whose leader has terminated.
+    void recover(void);
+
+    /// Withdraw the request of the given ticket unless already dequeued.
+    bool withdraw(const uint32_t ticket);
+
+    /// Check whether a request is ready to be dequeued.
+    bool isPending(void) const;
+
+    /// Execute all pending requests.
+    void drain(void);
+
+    /// Report the result of the request of the given ticket.
+    void complete(const uint32_t ticket, const Result::Result_ result);
+
+    /// Store the result of the given slot and wake its waiting instance.
+    static void complete(Slot & slot, const Result::Result_ result);
+
+    /// Wait until the request of the given ticket has been completed.
+    bool wait(const uint32_t ticket, int & exitCode);
+
+    /// Serialize the given request except for its start time.
+    static std::string serialize(const Request & request);
+
+    /// Deserialize the given request except for its start time.
+    static bool deserialize(const std::string & data, Request & request);
+};
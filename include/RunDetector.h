@@ -0,0 +1,104 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Types.h"
+
+/**
+ * @brief Class converting fixed rate samples to runs of equal samples.
+ *
+ * Samples are given either as one byte per sample (0 for a low, 1 for a high
+ * signal) or bit-packed into 64 bit words, least significant bit first. Byte
+ * samples are searched for transitions by the fastest kernel supported by
+ * the CPU: AVX2 or SSE2 selected at runtime on x86, NEON if enabled by the
+ * compiler flags on ARM, falling back to comparing eight samples per 64 bit
+ * word. Bit-packed samples are searched by counting the
+ * trailing zeros of the transitions within each word. Runs exceeding the
+ * maximum run length are split.
+ */
+class RunDetector {
+public:
+    /// Find the first sample differing from the given signal level.
+    static size_t findTransition(const uint8_t * samples, const size_t size,
+        const uint8_t level);
+
+    /// Scalar reference implementation of findTransition().
+    static size_t findTransitionScalar(const uint8_t * samples,
+        const size_t size, const uint8_t level);
+
+    /// Append the runs of the given byte samples.
+    static void detect(const uint8_t * samples, const size_t size,
+        std::vector<Types::Run> & runs);
+
+    /// Scalar reference implementation of detect().
+    static void detectScalar(const uint8_t * samples, const size_t size,
+        std::vector<Types::Run> & runs);
+
+    /// Append the runs of the given bit-packed samples.
+    static void detectPacked(const uint64_t * words, const size_t size,
+        std::vector<Types::Run> & runs);
+
+    /**
+     * @brief Get the names of all kernels of findTransition() supported by
+     *        the CPU, the fastest first.
+     */
+    static std::vector<std::string> getKernels(void);
+
+    /// Select the kernel of findTransition() by name.
+    static bool setKernel(const std::string & name);
+
+    /// Get the name of the instruction set used by findTransition().
+    static const char * getInstructionSet(void);
+
+private:
+    /// Kernel searching byte samples for transitions block by block.
+    struct Kernel {
+        /// Name of the instruction set.
+        const char * name;
+
+        /// Check whether the CPU supports the instruction set.
+        bool (*isSupported)(void);
+
+        /**
+         * @brief Get the number of samples preceding the first block
+         *        containing a transition.
+         */
+        size_t (*find)(const uint8_t * samples, const size_t size,
+            const uint8_t level);
+    };
+
+    /// All kernels compiled for the target architecture, the fastest first.
+    static const Kernel KERNELS[];
+
+    /// Kernel used by findTransition().
+    static const Kernel * kernel_;
+
+    /// Get the fastest kernel supported by the CPU.
+    static const Kernel * getFastestKernel(void);
+
+    /// Append the given number of samples of the given level.
+    static void append(const bool level, size_t samples,
+        std::vector<Types::Run> & runs);
+};
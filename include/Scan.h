@@ -26,13 +26,15 @@
 #include "Configuration.h"
 #include "ScanParameters.h"
 #include "Task.h"
+#include "Types.h"
 
 /// Class responsible for air scanning.
 class Scan : public Task {
 public:
     /// Class constructor.
     Scan(Configuration & configuration, const int32_t durationMs,
-        const std::string & dumpFile);
+        const std::string & dumpFile,
+        const Types::OutputFormat::OutputFormat_ outputFormat);
 
     /// Start the air scan.
     int start(void) final;
@@ -47,21 +49,33 @@ private:
     /// Dump file name or empty string to print scan results on stdout.
     const std::string dumpFile_;
 
+    /// Output format of the scan results.
+    const Types::OutputFormat::OutputFormat_ outputFormat_;
+
     /// Scan parameters.
     std::unique_ptr<ScanParameters> parameters_;
 
     /**
-     * @brief Vector containing the results of the air scan. A false element
-     *        indicates a low signal, a true element a high signal.
+     * @brief Vector containing the results of the air scan. A 0 element
+     *        indicates a low signal, a 1 element a high signal.
      */
-    std::vector<bool> data_;
+    std::vector<uint8_t> data_;
 
     /// Perform the air scan and store the results in 'data_'.
     void airScan(void);
 
+    /// Get the runs of the air scan results.
+    std::vector<Types::Run> getRuns(void) const;
+
     /// Print the air scan results to stdout.
     void printData(void) const;
 
     /// Serialize the air scan results to the dump file.
     void serializeData(void) const;
+
+    /// Learn a target section from the air scan results and print it.
+    bool learnTarget(void) const;
+
+    /// Print the unique frames of the air scan results, identified on request.
+    bool printFrames(void) const;
 };
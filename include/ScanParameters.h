@@ -44,6 +44,9 @@ public:
      */
     int32_t getSamplingRate(void) const;
 
+    /// Check whether air scan dumps will be compressed.
+    bool getCompressDump(void) const;
+
 private:
     /// Reference of the related configuration instance.
     const Configuration & configuration_;
@@ -57,9 +60,15 @@ private:
      */
     int32_t samplingRateUs_;
 
+    /// Flag to determine whether air scan dumps will be compressed.
+    bool compressDump_;
+
     /// Load the GPIO pin from the configuration.
     bool loadGpioPin(void);
 
     /// Load the sampling rate parameter from the configuration.
     bool loadSamplingRate(void);
+
+    /// Load the optional compress dump parameter from the configuration.
+    bool loadCompressDump(void);
 };
@@ -0,0 +1,97 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Configuration.h"
+#include "Target.h"
+#include "Task.h"
+#include "Types.h"
+
+/**
+ * @brief Class responsible for controlling several targets at once.
+ *
+ * The edges of all targets are merged into a single timeline and transmitted
+ * concurrently. Edges coinciding within COALESCE_US are written together.
+ * Targets sharing a GPIO pin are interleaved, i.e. the air command
+ * transmissions of one target fill the send delays of the others. Names of
+ * groups from the 'groups' section are replaced by their members.
+ */
+class Scene : public Task {
+public:
+    /// Class constructor.
+    Scene(Configuration & configuration,
+        const std::vector<std::string> & names);
+
+    /// Set the template variables given as target.name=value arguments.
+    bool setArguments(const std::vector<std::string> & arguments) final;
+
+    /// Start the scene control.
+    int start(void) final;
+
+private:
+    /// Target of the scene.
+    struct Member {
+        /// Target section name.
+        std::string name;
+
+        /**
+         * @brief Minimum low signal period before transmissions of the
+         *        target following transmissions of other targets.
+         * @note Unit: microseconds, Types::INVALID_PARAMETER for the send
+         *       delay of the preceding target
+         */
+        int32_t gapUs;
+
+        /// Target.
+        std::unique_ptr<Target> target;
+    };
+
+    /**
+     * @brief Maximum distance of edges written together.
+     * @note Unit: microseconds
+     */
+    static const uint64_t COALESCE_US = 10U;
+
+    /// Target and group names.
+    const std::vector<std::string> names_;
+
+    /// Template variables qualified by the target name.
+    std::vector<std::string> arguments_;
+
+    /// Targets of the scene, groups replaced by their members.
+    std::vector<Member> members_;
+
+    /// Create the targets of all target and group names.
+    bool loadMembers(void);
+
+    /// Schedule the transmissions of all targets sharing a GPIO pin.
+    std::vector<std::vector<uint64_t>> interleave(
+        const std::vector<const Member *> & members) const;
+
+    /// Control all targets.
+    void airControl(const std::vector<Types::Edge> & edges,
+        const uint32_t gpioPins) const;
+};
@@ -0,0 +1,81 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Configuration.h"
+#include "ScanParameters.h"
+#include "Target.h"
+#include "Task.h"
+
+/**
+ * @brief Class responsible for loopback self-tests of targets.
+ *
+ * The target is transmitted while a second thread captures the radio
+ * receiver of the air scan. The captured signal is aligned to the
+ * transmitted edges and decoded, the timing errors of all edges, the bit
+ * errors of the decoded air command and the latency from the first
+ * transmitted edge to its reception are written to stdout.
+ */
+class SelfTest : public Task {
+public:
+    /// Class constructor.
+    SelfTest(Configuration & configuration, const std::string & name);
+
+    /// Set the template variables of the target.
+    bool setArguments(const std::vector<std::string> & arguments) final;
+
+    /// Start the self-test.
+    int start(void) final;
+
+private:
+    /**
+     * @brief Period captured before the first and after the last edge.
+     * @note Unit: microseconds
+     */
+    static const uint64_t MARGIN_US = 50000U;
+
+    /// Target to be tested.
+    std::unique_ptr<Target> target_;
+
+    /// Scan parameters.
+    std::unique_ptr<ScanParameters> scanParameters_;
+
+    /// Captured samples of the radio receiver, 1 for a high signal.
+    std::vector<uint8_t> samples_;
+
+    /// Actual times of the captured samples (unit: microseconds).
+    std::vector<uint64_t> samplesUs_;
+
+    /// Capture the radio receiver within the given period.
+    void capture(const uint64_t startUs,
+        const std::atomic<uint64_t> & stopUs);
+
+    /// Compare the captured samples to the transmitted edges.
+    bool analyze(void) const;
+
+    /// Decode the captured samples and compare them to the air command.
+    bool decode(void) const;
+};
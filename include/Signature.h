@@ -0,0 +1,55 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Types.h"
+
+/**
+ * @brief Class computing timing independent signatures of pulse sequences.
+ *
+ * The pulse durations of a frame are grouped into clusters of similar
+ * durations, i.e. the short and long elements of an encoding and its sync
+ * pulses. The signature is the hash of the sequence of levels and cluster
+ * indexes, it neither depends on the absolute timing of the transmitter nor
+ * on the timing jitter of the receiver. Pulse sequences with equal signatures
+ * are compared pulse by pulse to rule out hash collisions.
+ */
+class Signature {
+public:
+    /// Pulse tolerance relative to the pulse duration (unit: percent).
+    static const uint32_t TOLERANCE_PERCENT = 25U;
+
+    /// Get the signature of the given pulse sequence.
+    static uint64_t hash(const std::vector<Types::Pulse> & pulses);
+
+    /// Check whether both pulse sequences match within the tolerance.
+    static bool isMatching(const std::vector<Types::Pulse> & a,
+        const std::vector<Types::Pulse> & b, const uint32_t minToleranceUs);
+
+private:
+    /**
+     * @brief Minimum ratio between the shortest durations of two clusters.
+     * @note Unit: percent
+     */
+    static const uint32_t CLUSTER_RATIO_PERCENT = 150U;
+};
@@ -19,12 +19,18 @@
 
 #pragma once
 
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <random>
 #include <string>
+#include <vector>
 
 #include "Configuration.h"
+#include "ScanParameters.h"
 #include "TargetParameters.h"
 #include "Task.h"
+#include "Types.h"
 
 /// Class responsible for target control.
 class Target : public Task {
@@ -32,28 +38,143 @@ public:
     /// Class constructor.
     Target(Configuration & configuration, const std::string & name);
 
+    /// Set the template variables given as name=value arguments.
+    bool setArguments(const std::vector<std::string> & arguments) final;
+
     /// Start the target control.
     int start(void) final;
 
+    /// Load and encode the target without transmitting it.
+    bool prepare(void);
+
+    /// Get the target parameters.
+    const TargetParameters & getParameters(void) const;
+
+    /// Get the air command with all template variables substituted.
+    const std::string & getAirCommand(void) const;
+
+    /// Get the pulses of a single air command transmission.
+    const std::vector<Types::Pulse> & getPulses(void) const;
+
+    /**
+     * @brief Get the duration of a single air command transmission.
+     * @note Unit: microseconds
+     */
+    uint64_t getFrameDuration(void) const;
+
+    /**
+     * @brief Get the longest possible duration of the target transmission,
+     *        including listen-before-talk backoffs and retransmissions.
+     * @note Unit: microseconds
+     */
+    uint64_t getMaxDuration(void) const;
+
+    /// Get all edges of the encoded target transmission.
+    std::vector<Types::Edge> getEdges(void) const;
+
+    /// Get all edges of air command transmissions starting at the given times.
+    std::vector<Types::Edge> getEdges(const std::vector<uint64_t> & framesUs)
+        const;
+
+    /**
+     * @brief Get all edges transmitted by the last airControl() at their
+     *        absolute deadlines, including retransmissions and backoffs.
+     */
+    std::vector<Types::Edge> getTransmittedEdges(void) const;
+
+    /**
+     * @brief Take the airtime of all transmissions, including all possible
+     *        retransmissions, from the airtime budget.
+     */
+    bool reserveAirtime(void);
+
+    /// Return the airtime of retransmissions not required to the budget.
+    void refundAirtime(void);
+
+    /**
+     * @brief Control the target.
+     * @note The GPIO access must have been set up.
+     */
+    bool airControl(void);
+
 private:
+    /// Maximum number of times a busy channel is listened to.
+    static const int32_t LISTEN_ATTEMPTS = 16;
+
+    /**
+     * @brief Default maximum delay of an edge relative to the shortest pulse
+     *        before its transmission is corrupted.
+     * @note Unit: percent
+     */
+    static const uint32_t DEADLINE_TOLERANCE_PERCENT = 25U;
+
+    /**
+     * @brief Minimum default maximum delay of an edge, above the scheduling
+     *        jitter of the Raspberry Pi.
+     * @note Unit: microseconds
+     */
+    static const uint32_t MIN_DEADLINE_TOLERANCE_US = 1000U;
+
     /// Target section name.
     const std::string name_;
 
     /// Target parameters.
     std::unique_ptr<TargetParameters> parameters_;
 
-    /// Control the target.
-    void airControl(void) const;
+    /// Values of the air command template variables.
+    std::map<std::string, std::string> variables_;
+
+    /// Pulses of all literal parts and fragments, each compiled once.
+    std::map<std::string, std::vector<Types::Pulse>> fragments_;
+
+    /// Air command with all template variables substituted.
+    std::string airCommand_;
+
+    /// Pulses of the encoded air command.
+    std::vector<Types::Pulse> pulses_;
+
+    /// Scan parameters or nullptr if listen-before-talk is disabled.
+    std::unique_ptr<ScanParameters> scanParameters_;
+
+    /**
+     * @brief Start times of all transmissions of the last airControl().
+     * @note Unit: microseconds
+     */
+    std::vector<uint64_t> framesUs_;
+
+    /// Get the maximum delay of an edge before its transmission is corrupted.
+    uint64_t getDeadlineTolerance(void) const;
+
+    /// Transmit the air command once starting at the given deadline.
+    bool transmit(uint64_t & deadlineUs, const uint64_t toleranceUs) const;
+
+    /// Listen to the channel until it is idle before a transmission.
+    uint64_t listen(const uint64_t deadlineUs, std::minstd_rand & random)
+        const;
+
+    /// Check whether the channel is busy within the given period.
+    bool isChannelBusy(const uint64_t beginUs, const uint64_t endUs) const;
+
+    /// Encode the air command, substituting all template variables.
+    bool encode(void);
+
+    /// Encode the given template variable value.
+    bool encodeVariable(const std::string & name);
+
+    /// Get the pulses of the given air command, compiled on first use.
+    const std::vector<Types::Pulse> & compile(const std::string & airCommand);
 
-    /// Send the air command with Manchester encoding.
-    void sendAirCommandManchester(void) const;
+    /// Append the given air command to the encoded air command.
+    void append(const std::string & airCommand);
 
-    /// Send the air command with RCO encoding.
-    void sendAirCommandRemoteControlledOutled(void) const;
+    /// Append the given pulses to the encoded air command.
+    void splice(const std::vector<Types::Pulse> & pulses);
 
-    /// Send the air command with Tormatic encoding.
-    void sendAirCommandTormatic(void) const;
+    /// Encode the given air command with the encoder of the given air code.
+    template <Types::AirCode::AirCode_ CODE>
+    std::vector<Types::Pulse> encode(const std::string & airCommand) const;
 
-    /// Send the air command with Melitec encoding.
-    void sendAirCommandMelitec(void) const;
+    /// Encode the given air command with the given custom encoding.
+    std::vector<Types::Pulse> encode(const EncodingParameters & encoding,
+        const std::string & airCommand) const;
 };
@@ -0,0 +1,79 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Configuration.h"
+#include "Types.h"
+
+/**
+ * @brief Class identifying received frames by the configured targets.
+ *
+ * All target sections of the configuration are encoded once and indexed by
+ * the signatures of their frames, i.e. identifying a received frame takes a
+ * single lookup regardless of the number of targets. Target templates are not
+ * indexed since their air commands depend on command line arguments.
+ */
+class TargetIndex {
+public:
+    /// Class constructor.
+    explicit TargetIndex(Configuration & configuration);
+
+    /// Encode and index all target sections of the configuration.
+    bool load(const int32_t frameGapUs);
+
+    /// Get the names of all targets transmitting the given pulses.
+    std::vector<std::string> identify(const std::vector<Types::Pulse> & pulses,
+        const int32_t samplingRateUs) const;
+
+private:
+    /// Indexed frame of a target.
+    struct Entry {
+        /// Target section name.
+        std::string name;
+
+        /// Pulses of the frame.
+        std::vector<Types::Pulse> pulses;
+    };
+
+    /**
+     * @brief Minimum pulse tolerance, covering the pulse distortion of
+     *        common radio receivers.
+     * @note Unit: microseconds
+     */
+    static const uint32_t MIN_TOLERANCE_US = 100U;
+
+    /// Reference of the configuration.
+    Configuration & configuration_;
+
+    /// Indexed frames of all targets.
+    std::vector<Entry> entries_;
+
+    /// Indexed frames by signature of their pulse sequence.
+    std::unordered_multimap<uint64_t, size_t> index_;
+
+    /// Index the frames of the given target pulses.
+    void add(const std::string & name,
+        const std::vector<Types::Pulse> & pulses, const int32_t frameGapUs);
+};
@@ -19,14 +19,27 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "Configuration.h"
+#include "EncodingParameters.h"
 #include "Types.h"
 
 /// Class holding all parameters required for Target tasks.
 class TargetParameters {
 public:
+    /// Part of an air command template.
+    struct Part {
+        /// True if the part is a variable, false for literal elements.
+        bool isVariable;
+
+        /// Variable name or literal data and sync elements.
+        std::string text;
+    };
+
     /// Class constructor.
     TargetParameters(const Configuration & configuration,
         const std::string & name);
@@ -55,9 +68,27 @@ public:
     /// Get the radio frame encoding type.
     Types::AirCode::AirCode_ getAirCode(void) const;
 
+    /// Check whether a custom encoding is used instead of an air code.
+    bool isCustomEncoding(void) const;
+
+    /// Get the custom encoding.
+    const EncodingParameters & getEncoding(void) const;
+
     /// Get the sequence string of data and sync elements to be transmitted.
     std::string getAirCommand(void) const;
 
+    /**
+     * @brief Get the literal and variable parts of the air command.
+     * @note A single literal part unless the air command is a template.
+     */
+    const std::vector<Part> & getAirCommandParts(void) const;
+
+    /// Get all data and sync elements valid for the air code.
+    std::string getAlphabet(void) const;
+
+    /// Get the fragment of the given name.
+    bool getFragment(const std::string & name, std::string & fragment) const;
+
     /// Get the number of times the air command will be transmitted.
     int32_t getSendCommand(void) const;
 
@@ -67,7 +98,41 @@ public:
      */
     int32_t getSendDelay(void) const;
 
+    /**
+     * @brief Get the period the channel is listened to before each
+     *        transmission, zero if listen-before-talk is disabled.
+     * @note Unit: microseconds
+     */
+    int32_t getListenWindow(void) const;
+
+    /**
+     * @brief Get the maximum random delay before listening again to a busy
+     *        channel.
+     * @note Unit: microseconds
+     */
+    int32_t getListenBackoff(void) const;
+
+    /**
+     * @brief Get the maximum delay of an edge before its transmission is
+     *        corrupted, Types::INVALID_PARAMETER if not configured.
+     * @note Unit: microseconds
+     */
+    int32_t getDeadlineTolerance(void) const;
+
+    /// Get the maximum number of retransmissions of corrupted transmissions.
+    int32_t getMaxRetransmits(void) const;
+
 private:
+    /**
+     * @brief Default maximum random delay before listening again to a busy
+     *        channel.
+     * @note Unit: microseconds
+     */
+    static const int32_t DEFAULT_LISTEN_BACKOFF_US = 10000;
+
+    /// Default maximum number of retransmissions of corrupted transmissions.
+    static const int32_t DEFAULT_MAX_RETRANSMITS = 0;
+
     /// Reference of the related configuration instance.
     const Configuration & configuration_;
 
@@ -92,9 +157,18 @@ private:
     /// Radio frame encoding type.
     Types::AirCode::AirCode_ airCode_;
 
+    /// Custom encoding or nullptr if a built-in air code is used.
+    std::unique_ptr<EncodingParameters> encoding_;
+
     /// Sequence string of data and sync elements to be transmitted.
     std::string airCommand_;
 
+    /// Literal and variable parts of the air command.
+    std::vector<Part> airCommandParts_;
+
+    /// Named sequences of data and sync elements for template variables.
+    std::map<std::string, std::string> fragments_;
+
     /// Number of times the air command will be transmitted.
     int32_t sendCommand_;
 
@@ -104,6 +178,27 @@ private:
      */
     int32_t sendDelayUs_;
 
+    /**
+     * @brief Period the channel is listened to before each transmission.
+     * @note Unit: microseconds
+     */
+    int32_t listenWindowUs_;
+
+    /**
+     * @brief Maximum random delay before listening again to a busy channel.
+     * @note Unit: microseconds
+     */
+    int32_t listenBackoffUs_;
+
+    /**
+     * @brief Maximum delay of an edge before its transmission is corrupted.
+     * @note Unit: microseconds
+     */
+    int32_t deadlineToleranceUs_;
+
+    /// Maximum number of retransmissions of corrupted transmissions.
+    int32_t maxRetransmits_;
+
     /**
      * @brief Get the requested configuration value from either the given
      *        section or the "target" section.
@@ -138,9 +233,18 @@ private:
     /// Load the air command parameter from the configuration.
     bool loadAirCommand(void);
 
+    /// Load the optional fragments parameter from the configuration.
+    bool loadFragments(void);
+
     /// Load the send command parameter from the configuration.
     bool loadSendCommand(void);
 
     /// Load the send delay parameter from the configuration.
     bool loadSendDelay(void);
+
+    /// Load the optional listen-before-talk parameters from the configuration.
+    bool loadListen(void);
+
+    /// Load the optional retransmission parameters from the configuration.
+    bool loadRetransmit(void);
 };
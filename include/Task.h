@@ -20,22 +20,92 @@
 #pragma once
 
 #include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "Clock.h"
 #include "Configuration.h"
+#include "Trace.h"
 #include "Types.h"
 
 /// Base class for all task classes.
 class Task {
 public:
+    /// Timing statistics of a task and all edges written or read by it.
+    struct Timing {
+        /**
+         * @brief Time the GPIO setup has been started, zero if none is
+         *        required.
+         * @note Unit: microseconds
+         */
+        uint64_t gpioSetupUs;
+
+        /**
+         * @brief Time the GPIO setup has been completed.
+         * @note Unit: microseconds
+         */
+        uint64_t gpioReadyUs;
+
+        /**
+         * @brief Actual time of the first edge.
+         * @note Unit: microseconds
+         */
+        uint64_t firstEdgeUs;
+
+        /**
+         * @brief Actual time of the last edge.
+         * @note Unit: microseconds
+         */
+        uint64_t lastEdgeUs;
+
+        /// Number of edges.
+        uint32_t edges;
+
+        /// Number of edges which missed their intended time.
+        uint32_t overruns;
+
+        /// Number of transmissions deferred since the channel was busy.
+        uint32_t backoffs;
+
+        /// Number of transmissions corrupted by edges missing their deadline.
+        uint32_t corruptions;
+
+        /// Number of transmissions repeated since they were corrupted.
+        uint32_t retransmissions;
+
+        /**
+         * @brief Airtime taken from the airtime budget.
+         * @note Unit: microseconds
+         */
+        uint64_t airtimeUs;
+    };
+
     /// Class constructor.
     Task(Configuration & configuration);
 
     /// Check if the given GPIO pin is valid.
     static bool isValidGpioPin(const uint8_t gpioPin);
 
+    /// Disable all GPIO access, required by tasks not running on the board.
+    static void disableGpio(void);
+
     /// Set the GPIO pin.
     void setGpioPin(const uint8_t gpioPin);
 
+    /// Enable tracing of all edges to the given file.
+    void setTraceFile(const std::string & traceFile);
+
+    /// Write the recorded edges to the trace file if tracing is enabled.
+    bool flushTrace(void) const;
+
+    /// Get the timing statistics of the task.
+    const Timing & getTiming(void) const;
+
+    /// Set the positional command line arguments following the command.
+    virtual bool setArguments(const std::vector<std::string> & arguments);
+
     /// Start the task.
     virtual int start(void) = 0;
 
@@ -45,4 +115,55 @@ protected:
 
     /// Reference of the configuration.
     Configuration & configuration_;
+
+    /// Edge trace or nullptr if tracing is disabled.
+    std::unique_ptr<Trace> trace_;
+
+    /// Timing statistics of the task, updated by const timing loops too.
+    mutable Timing timing_;
+
+    /// Set up the GPIO access, required only by tasks accessing GPIO pins.
+    bool setupGpio(void);
+
+    /// Take the given airtime per GPIO pin from the airtime budget.
+    bool acquireAirtime(const std::map<uint8_t, uint64_t> & airtimeUs);
+
+    /// Return unused airtime per GPIO pin to the airtime budget.
+    void releaseAirtime(const std::map<uint8_t, uint64_t> & airtimeUs);
+
+    /**
+     * @brief Record an edge at the current time.
+     * @param intendedUs Intended time of the edge (unit: microseconds).
+     * @param level Signal level after the edge, true for a high signal.
+     * @return Actual time of the edge (unit: microseconds).
+     */
+    inline uint64_t recordEdge(const uint64_t intendedUs, const bool level)
+            const {
+        const uint64_t actualUs = Clock::now();
+
+        if (timing_.edges == 0U) {
+            timing_.firstEdgeUs = actualUs;
+        }
+        timing_.lastEdgeUs = actualUs;
+        timing_.edges++;
+        if (actualUs > intendedUs + OVERRUN_THRESHOLD_US) {
+            timing_.overruns++;
+        }
+
+        if (trace_ != nullptr) {
+            trace_->record(intendedUs, actualUs, level);
+        }
+
+        return actualUs;
+    }
+
+private:
+    /**
+     * @brief Delay after which an edge has missed its intended time.
+     * @note Unit: microseconds
+     */
+    static const uint64_t OVERRUN_THRESHOLD_US = 100U;
+
+    /// True if the GPIO access is disabled.
+    static bool isGpioDisabled_;
 };
@@ -0,0 +1,87 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Class recording the timing of all edges written or read by a task.
+ *
+ * The edges are recorded to a preallocated ring which overwrites the oldest
+ * edges when full. Recording neither allocates memory nor locks, it can be
+ * used within timing critical loops without adding jitter. The ring is
+ * written to a CSV file after the task has completed.
+ */
+class Trace {
+public:
+    /// Class constructor.
+    explicit Trace(const std::string & traceFile);
+
+    /**
+     * @brief Record an edge.
+     * @param intendedUs Intended time of the edge (unit: microseconds).
+     * @param actualUs Actual time of the edge (unit: microseconds).
+     * @param level Signal level after the edge, true for a high signal.
+     */
+    inline void record(const uint64_t intendedUs, const uint64_t actualUs,
+            const bool level) {
+        Edge & edge = edges_[count_ & (CAPACITY - 1U)];
+        edge.actualUs = actualUs;
+        edge.intendedUs = intendedUs;
+        edge.level = level;
+        count_++;
+    }
+
+    /// Write all recorded edges to the trace file.
+    bool flush(void) const;
+
+private:
+    /// Maximum number of edges kept, must be a power of two.
+    static const size_t CAPACITY = 1U << 16U;
+
+    /// Single recorded edge.
+    struct Edge {
+        /**
+         * @brief Intended time of the edge.
+         * @note Unit: microseconds
+         */
+        uint64_t intendedUs;
+
+        /**
+         * @brief Actual time of the edge.
+         * @note Unit: microseconds
+         */
+        uint64_t actualUs;
+
+        /// Signal level after the edge, true for a high signal.
+        bool level;
+    };
+
+    /// Trace file name.
+    const std::string traceFile_;
+
+    /// Ring of recorded edges.
+    std::vector<Edge> edges_;
+
+    /// Total number of edges recorded.
+    uint64_t count_;
+};
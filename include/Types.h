@@ -36,9 +36,76 @@ struct AirCode {
     };
 };
 
+/// Supported output formats.
+struct OutputFormat {
+    /// Supported output formats.
+    enum OutputFormat_ {
+        TEXT = 0,
+        JSON = 1,
+        TARGET = 2,
+        FRAMES = 3,
+        IDENTIFY = 4,
+        MAX
+    };
+};
+
+/// Run of consecutive samples sharing the same signal level.
+struct Run {
+    /// Signal level, true for a high signal.
+    bool level;
+
+    /// Number of consecutive samples.
+    uint32_t samples;
+};
+
+/// Constant signal level of a given duration.
+struct Pulse {
+    /// Signal level, true for a high signal.
+    bool level;
+
+    /**
+     * @brief Pulse duration.
+     * @note Unit: microseconds
+     */
+    uint32_t durationUs;
+};
+
+/// Signal level transition of a GPIO pin at a given time.
+struct Edge {
+    /**
+     * @brief Time of the edge relative to the first edge.
+     * @note Unit: microseconds
+     */
+    uint64_t timeUs;
+
+    /// GPIO pin.
+    uint8_t gpioPin;
+
+    /// Signal level after the edge, true for a high signal.
+    bool level;
+};
+
+/// Single radio frame within a stream of samples.
+struct Frame {
+    /// Offset of the first frame sample within the stream.
+    uint64_t offset;
+
+    /// Number of frame samples.
+    uint64_t samples;
+};
+
 /// Signature to be used to identify dump files.
 static const uint32_t DUMP_SIGNATURE = 0xDEADC0DEU;
 
+/// Signature to be used to identify compressed dump files.
+static const uint32_t DUMP_SIGNATURE_COMPRESSED = 0xDEADC0DFU;
+
+/// Signature to be used to identify frame index files.
+static const uint32_t INDEX_SIGNATURE = 0xDEADF00EU;
+
+/// Name of target sections learned from air scan data.
+static const char * const LEARNED_TARGET_NAME = "learned_target";
+
 /// Invalid GPIO pin marker.
 static const uint8_t INVALID_GPIO_PIN = UINT8_MAX;
 
@@ -0,0 +1,9 @@
+// This file will be generated during the build process. Do not edit, any 
+// changes will be lost. See 'scripts/version.sh'.
+
+#pragma once
+
+#include <string>
+
+/// Version string.
+const std::string VERSION = "0.0.0+801055fd756274c95b63a2889ea34c1b63ce5733";
@@ -0,0 +1,96 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+
+#include "AirCodeTraits.h"
+
+// Definitions of the static members odr-used at runtime
+constexpr AirSymbol AirCodeTraits<Types::AirCode::MANCHESTER>::SYMBOLS[];
+constexpr AirSymbol
+    AirCodeTraits<Types::AirCode::REMOTE_CONTROLLED_OUTLET>::SYMBOLS[];
+constexpr AirSymbol AirCodeTraits<Types::AirCode::TORMATIC>::SYMBOLS[];
+constexpr AirSymbol AirCodeTraits<Types::AirCode::MELITEC>::SYMBOLS[];
+
+/**
+ * @param airCode Air code.
+ * @return Symbols of the air code.
+ */
+AirCodes::Symbols AirCodes::getSymbols(
+        const Types::AirCode::AirCode_ airCode) {
+    switch (airCode) {
+        case Types::AirCode::MANCHESTER:
+            return getSymbols<AirCodeTraits<Types::AirCode::MANCHESTER>>();
+
+        case Types::AirCode::REMOTE_CONTROLLED_OUTLET:
+            return getSymbols<AirCodeTraits<
+                Types::AirCode::REMOTE_CONTROLLED_OUTLET>>();
+
+        case Types::AirCode::TORMATIC:
+            return getSymbols<AirCodeTraits<Types::AirCode::TORMATIC>>();
+
+        case Types::AirCode::MELITEC:
+            return getSymbols<AirCodeTraits<Types::AirCode::MELITEC>>();
+
+        case Types::AirCode::MAX:
+        default:
+            assert(false);
+            return { nullptr, nullptr };
+    }
+}
+
+/**
+ * @param airCode Air code.
+ * @return Name of the air code.
+ */
+const char * AirCodes::getName(const Types::AirCode::AirCode_ airCode) {
+    switch (airCode) {
+        case Types::AirCode::MANCHESTER:
+            return AirCodeTraits<Types::AirCode::MANCHESTER>::NAME;
+
+        case Types::AirCode::REMOTE_CONTROLLED_OUTLET:
+            return AirCodeTraits<
+                Types::AirCode::REMOTE_CONTROLLED_OUTLET>::NAME;
+
+        case Types::AirCode::TORMATIC:
+            return AirCodeTraits<Types::AirCode::TORMATIC>::NAME;
+
+        case Types::AirCode::MELITEC:
+            return AirCodeTraits<Types::AirCode::MELITEC>::NAME;
+
+        case Types::AirCode::MAX:
+        default:
+            assert(false);
+            return "";
+    }
+}
+
+/**
+ * @param airCode Air code.
+ * @return Characters of all symbols of the air code.
+ */
+std::string AirCodes::getAlphabet(const Types::AirCode::AirCode_ airCode) {
+    std::string alphabet;
+
+    for (const auto & symbol : getSymbols(airCode)) {
+        alphabet += symbol.character;
+    }
+
+    return alphabet;
+}
@@ -0,0 +1,263 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+#include "Airtime.h"
+#include "Clock.h"
+
+/// @param parameters Reference of the airtime parameters.
+Airtime::Airtime(const AirtimeParameters & parameters) :
+        parameters_(parameters) {
+    // Do nothing
+}
+
+/**
+ * @param airtimeUs Airtime per GPIO pin (unit: microseconds).
+ * @return True if the airtime has been taken, false otherwise.
+ *
+ * If a bucket does not hold enough airtime the invocation either sleeps
+ * until it has been refilled or fails, depending on the policy. The state
+ * file is not locked while sleeping.
+ */
+bool Airtime::acquire(const std::map<uint8_t, uint64_t> & airtimeUs) const {
+    const double dutyCycle = parameters_.getDutyCycle();
+    const double capacityUs = getCapacity();
+
+    for (const auto & request : airtimeUs) {
+        if (request.second > capacityUs) {
+            std::cerr << "Error: Airtime of " << request.second / 1000U
+                << "ms on GPIO pin " << +request.first << " exceeds the "
+                "budget of " << static_cast<uint64_t>(capacityUs) / 1000U
+                << "ms" << std::endl;
+            return false;
+        }
+    }
+
+    const std::string & stateFile = parameters_.getStateFile();
+    while (true) {
+        const int fd = open(stateFile.c_str(), O_RDWR | O_CREAT, S_IRUSR
+            | S_IWUSR | S_IRGRP | S_IROTH);
+        std::map<uint8_t, Bucket> buckets;
+        if ((fd < 0) || (flock(fd, LOCK_EX) != 0) || !read(fd, buckets)) {
+            std::cerr << "Error: Airtime state file '" << stateFile
+                << "' cannot be read" << std::endl;
+            if (fd >= 0) {
+                close(fd);
+            }
+            return false;
+        }
+
+        // Refill the buckets and determine the period until all of them hold
+        // the requested airtime
+        const uint64_t nowUs = now();
+        uint64_t waitUs = 0U;
+        for (const auto & request : airtimeUs) {
+            const Bucket & bucket = refill(buckets, request.first, nowUs);
+            if (request.second > bucket.tokensUs) {
+                const uint64_t missingUs = static_cast<uint64_t>(
+                    (request.second - bucket.tokensUs) / dutyCycle);
+                std::cerr << "Warning: Airtime budget of GPIO pin "
+                    << +request.first << " exhausted, "
+                    << static_cast<uint64_t>(bucket.tokensUs) / 1000U
+                    << "ms remaining, " << request.second / 1000U
+                    << "ms required, available in " << missingUs / 1000U
+                    << "ms" << std::endl;
+                waitUs = std::max(waitUs, missingUs);
+            }
+        }
+
+        if (waitUs == 0U) {
+            for (const auto & request : airtimeUs) {
+                buckets[request.first].tokensUs -= request.second;
+            }
+            const bool isSuccess = save(fd, buckets);
+            if (!isSuccess) {
+                std::cerr << "Error: Airtime state file '" << stateFile
+                    << "' cannot be written" << std::endl;
+            }
+
+            // Closing the file releases the lock
+            close(fd);
+            return isSuccess;
+        }
+
+        close(fd);
+        if (parameters_.getPolicy() == AirtimeParameters::Policy::REJECT) {
+            return false;
+        }
+        Clock::sleepUntil(Clock::now() + waitUs);
+    }
+}
+
+/**
+ * @param airtimeUs Airtime per GPIO pin (unit: microseconds).
+ * @return Status of the operation.
+ *
+ * Used to refund airtime acquired for the worst case, e.g. retransmissions
+ * which have not been required. The buckets are not filled beyond their
+ * capacity.
+ */
+bool Airtime::release(const std::map<uint8_t, uint64_t> & airtimeUs) const {
+    const std::string & stateFile = parameters_.getStateFile();
+    const int fd = open(stateFile.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR
+        | S_IRGRP | S_IROTH);
+    std::map<uint8_t, Bucket> buckets;
+    if ((fd < 0) || (flock(fd, LOCK_EX) != 0) || !read(fd, buckets)) {
+        std::cerr << "Error: Airtime state file '" << stateFile
+            << "' cannot be read" << std::endl;
+        if (fd >= 0) {
+            close(fd);
+        }
+        return false;
+    }
+
+    const uint64_t nowUs = now();
+    for (const auto & request : airtimeUs) {
+        Bucket & bucket = refill(buckets, request.first, nowUs);
+        bucket.tokensUs = std::min(getCapacity(),
+            bucket.tokensUs + request.second);
+    }
+
+    const bool isSuccess = save(fd, buckets);
+    if (!isSuccess) {
+        std::cerr << "Error: Airtime state file '" << stateFile
+            << "' cannot be written" << std::endl;
+    }
+
+    // Closing the file releases the lock
+    close(fd);
+    return isSuccess;
+}
+
+/// @return Capacity of each bucket (unit: microseconds).
+double Airtime::getCapacity(void) const {
+    const double MICROSECONDS_PER_SECOND = 1e6;
+
+    return parameters_.getDutyCycle() * parameters_.getPeriod()
+        * MICROSECONDS_PER_SECOND;
+}
+
+/**
+ * @param buckets Buckets of all GPIO pins.
+ * @param gpioPin GPIO pin of the bucket, a full bucket is added if missing.
+ * @param nowUs Current wall clock time (unit: microseconds).
+ * @return Refilled bucket.
+ */
+Airtime::Bucket & Airtime::refill(std::map<uint8_t, Bucket> & buckets,
+        const uint8_t gpioPin, const uint64_t nowUs) const {
+    auto bucket = buckets.find(gpioPin);
+
+    if (bucket == buckets.end()) {
+        bucket = buckets.insert({ gpioPin, { getCapacity(), nowUs } }).first;
+    } else if (nowUs > bucket->second.updatedUs) {
+        bucket->second.tokensUs = std::min(getCapacity(),
+            bucket->second.tokensUs + (nowUs - bucket->second.updatedUs)
+            * parameters_.getDutyCycle());
+    }
+    bucket->second.updatedUs = nowUs;
+
+    return bucket->second;
+}
+
+/**
+ * @return Current wall clock time.
+ *
+ * The update times are persisted in the state file, so the monotonic
+ * Clock::now() cannot be used: it restarts at boot, after which all buckets
+ * would appear to be updated in the future and never be refilled.
+ */
+uint64_t Airtime::now(void) {
+    const uint64_t MICROSECONDS_PER_SECOND = 1000000U;
+    const uint64_t NANOSECONDS_PER_MICROSECOND = 1000U;
+    struct timespec time;
+
+    clock_gettime(CLOCK_REALTIME, &time);
+
+    return static_cast<uint64_t>(time.tv_sec) * MICROSECONDS_PER_SECOND
+        + static_cast<uint64_t>(time.tv_nsec) / NANOSECONDS_PER_MICROSECOND;
+}
+
+/**
+ * @param fd Descriptor of the locked state file.
+ * @param buckets Place to store the buckets to.
+ * @return Status of the operation.
+ *
+ * The state file contains one line per GPIO pin with the pin, the available
+ * airtime and the time of the last update (unit: microseconds). An empty
+ * file holds no buckets.
+ */
+bool Airtime::read(const int fd, std::map<uint8_t, Bucket> & buckets) {
+    std::string content;
+    char buffer[256];
+    ssize_t length;
+
+    while ((length = ::read(fd, buffer, sizeof(buffer))) > 0) {
+        content.append(buffer, static_cast<size_t>(length));
+    }
+    if (length < 0) {
+        return false;
+    }
+
+    std::istringstream lines(content);
+    std::string line;
+    while (std::getline(lines, line)) {
+        std::istringstream fields(line);
+        uint32_t pin;
+        Bucket bucket;
+        if (line.empty() || (line.front() == '#')) {
+            continue;
+        } else if (!(fields >> pin >> bucket.tokensUs >> bucket.updatedUs)
+            || (pin >= UINT8_MAX)) {
+            return false;
+        }
+        buckets[static_cast<uint8_t>(pin)] = bucket;
+    }
+
+    return true;
+}
+
+/**
+ * @param fd Descriptor of the locked state file.
+ * @param buckets Buckets to be written.
+ * @return Status of the operation.
+ */
+bool Airtime::save(const int fd, const std::map<uint8_t, Bucket> & buckets) {
+    std::ostringstream content;
+
+    content << "# gpio_pin available_us updated_us" << std::endl;
+    for (const auto & bucket : buckets) {
+        content << +bucket.first << ' '
+            << static_cast<int64_t>(bucket.second.tokensUs) << ' '
+            << bucket.second.updatedUs << std::endl;
+    }
+
+    const std::string data = content.str();
+    return (ftruncate(fd, 0) == 0)
+        && (pwrite(fd, data.c_str(), data.length(), 0)
+        == static_cast<ssize_t>(data.length()));
+}
@@ -0,0 +1,123 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <iostream>
+
+#include "AirtimeParameters.h"
+
+/// @param configuration Reference of the configuration.
+AirtimeParameters::AirtimeParameters(const Configuration & configuration) :
+        configuration_(configuration),
+        stateFile_(),
+        dutyCycle_(0.0),
+        periodS_(3600),
+        policy_(Policy::DEFER) {
+    // Do nothing
+}
+
+/**
+ * @return Status of the operation.
+ *
+ * All other parameters are loaded only if the limiter is enabled.
+ */
+bool AirtimeParameters::load(void) {
+    return loadStateFile()
+        && (stateFile_.empty()
+        || (loadDutyCycle() && loadPeriod() && loadPolicy()));
+}
+
+/// @return State file, an empty string if the limiter is disabled.
+const std::string & AirtimeParameters::getStateFile(void) const {
+    return stateFile_;
+}
+
+/// @return Maximum fraction of time a GPIO pin may transmit.
+double AirtimeParameters::getDutyCycle(void) const {
+    assert(dutyCycle_ > 0.0);
+    return dutyCycle_;
+}
+
+/// @return Period the duty cycle applies to.
+int32_t AirtimeParameters::getPeriod(void) const {
+    return periodS_;
+}
+
+/// @return Policy applied if the airtime budget is exhausted.
+AirtimeParameters::Policy::Policy_ AirtimeParameters::getPolicy(void) const {
+    return policy_;
+}
+
+/// @return True if successful, false otherwise.
+bool AirtimeParameters::loadStateFile(void) {
+    // The limiter is disabled if the parameter is not configured
+    if (!configuration_.getValue("airtime", "stateFile", stateFile_)) {
+        stateFile_.clear();
+    }
+
+    return true;
+}
+
+/// @return True if successful, false otherwise.
+bool AirtimeParameters::loadDutyCycle(void) {
+    if (!configuration_.getValue("airtime", "dutyCycle", dutyCycle_)) {
+        std::cerr << "Error: Missing configuration parameter 'dutyCycle'"
+            << std::endl;
+        return false;
+    }
+
+    if ((dutyCycle_ <= 0.0) || (dutyCycle_ > 1.0)) {
+        std::cerr << "Error: Configuration error (airtime): dutyCycle must "
+            "be within (0, 1]" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/// @return True if successful, false otherwise.
+bool AirtimeParameters::loadPeriod(void) {
+    configuration_.getValue("airtime", "period", periodS_);
+
+    if (periodS_ <= 0) {
+        std::cerr << "Error: Configuration error (airtime): period is "
+            "invalid" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/// @return True if successful, false otherwise.
+bool AirtimeParameters::loadPolicy(void) {
+    std::string policy;
+
+    if (!configuration_.getValue("airtime", "policy", policy)
+        || (policy == "defer")) {
+        policy_ = Policy::DEFER;
+    } else if (policy == "reject") {
+        policy_ = Policy::REJECT;
+    } else {
+        std::cerr << "Error: Configuration error (airtime): policy must be "
+            "either 'defer' or 'reject'" << std::endl;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,351 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string.h>
+#include <thread>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Benchmark.h"
+#include "Clock.h"
+#include "DumpAnalysis.h"
+#include "DumpReader.h"
+#include "DumpWriter.h"
+#include "ReplayParameters.h"
+#include "RunDetector.h"
+
+/**
+ * @param configuration Reference of the configuration.
+ * @param dumpFile File name of the air scan dump to be benchmarked with.
+ * @param outputFile File name of the compressed dump or empty string to
+ *                   discard it.
+ */
+Benchmark::Benchmark(Configuration & configuration,
+        const std::string & dumpFile, const std::string & outputFile) :
+        Task(configuration),
+        dumpFile_(dumpFile),
+        outputFile_(outputFile),
+        samplingRateUs_(Types::INVALID_PARAMETER),
+        runs_() {
+    // Do nothing
+}
+
+/// @return Program exit code.
+int Benchmark::start(void) {
+    uint64_t durationUs;
+
+    // GPIO pins are validated without detecting the board revision, the
+    // benchmark runs on any machine
+    Task::disableGpio();
+
+    if (!loadDump(durationUs)) {
+        return EXIT_FAILURE;
+    }
+
+    uint64_t samples = 0U;
+    for (const auto & run : runs_) {
+        samples += run.samples;
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+        << "Air scan dump:       " << dumpFile_ << std::endl
+        << "Samples:             " << samples << " (" << runs_.size()
+        << " runs)" << std::endl
+        << "Duration:            " << samples * samplingRateUs_ / 1000U
+        << "ms" << std::endl
+        << "Loading:             " << getThroughput(samples, durationUs)
+        << "MB/s" << std::endl;
+
+    return (benchmarkRunDetection() && benchmarkAnalysis()
+        && benchmarkCompression()) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @param durationUs Place to store the loading duration to (unit:
+ *                   microseconds).
+ * @return Status of the operation.
+ */
+bool Benchmark::loadDump(uint64_t & durationUs) {
+    const uint64_t startUs = Clock::now();
+    DumpReader reader(dumpFile_);
+
+    if (!reader.open()) {
+        return false;
+    }
+    samplingRateUs_ = reader.getSamplingRate();
+
+    Types::Run run;
+    while (reader.read(run)) {
+        runs_.push_back(run);
+    }
+    durationUs = Clock::now() - startUs;
+
+    if (reader.hasFailed()) {
+        return false;
+    } else if (runs_.size() == 0U) {
+        std::cerr << "Error: Given air scan dump seems corrupted (no data "
+            "elements found)" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * The samples of the dump are expanded to one byte per sample and bit-packed,
+ * the runs detected by all kernels supported by the CPU and the bit-packed
+ * kernel are verified against the scalar reference. The throughput is
+ * related to the number of samples.
+ *
+ * @return Status of the operation.
+ */
+bool Benchmark::benchmarkRunDetection(void) const {
+    const size_t WORD_BITS = 64U;
+
+    // Expand the samples, limited to keep the memory footprint reasonable
+    std::vector<uint8_t> samples;
+    for (auto i = 0U; (i < runs_.size())
+            && (samples.size() < MAX_DETECTION_SAMPLES); i++) {
+        samples.insert(samples.end(), std::min<size_t>(runs_[i].samples,
+            MAX_DETECTION_SAMPLES - samples.size()), runs_[i].level ? 1U : 0U);
+    }
+    std::vector<uint64_t> words((samples.size() + WORD_BITS - 1U)
+        / WORD_BITS);
+    for (auto i = 0U; i < samples.size(); i++) {
+        words[i / WORD_BITS] |= static_cast<uint64_t>(samples[i])
+            << (i % WORD_BITS);
+    }
+
+    std::vector<Types::Run> reference;
+    uint64_t startUs = Clock::now();
+    RunDetector::detectScalar(samples.data(), samples.size(), reference);
+    const uint64_t scalarUs = Clock::now() - startUs;
+
+    // Each kernel is measured, the fastest one is selected again afterwards
+    const std::vector<std::string> kernels = RunDetector::getKernels();
+    std::vector<uint64_t> kernelsUs;
+    bool isValid = true;
+    for (const auto & kernel : kernels) {
+        std::vector<Types::Run> vectorized;
+        vectorized.reserve(reference.size());
+        RunDetector::setKernel(kernel);
+        startUs = Clock::now();
+        RunDetector::detect(samples.data(), samples.size(), vectorized);
+        kernelsUs.push_back(Clock::now() - startUs);
+        isValid = isValid && isEqual(vectorized, reference);
+    }
+    RunDetector::setKernel(kernels.front());
+
+    std::vector<Types::Run> packed;
+    packed.reserve(reference.size());
+    startUs = Clock::now();
+    RunDetector::detectPacked(words.data(), samples.size(), packed);
+    const uint64_t packedUs = Clock::now() - startUs;
+
+    if (!isValid || !isEqual(packed, reference)) {
+        std::cerr << "Error: Detected runs differ from the scalar reference"
+            << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0U; i < kernels.size(); i++) {
+        std::cout << "Run detection:       "
+            << getThroughput(samples.size(), kernelsUs[i]) << "MB/s ("
+            << kernels[i] << ")" << std::endl;
+    }
+    std::cout << "Run detection (ref): "
+        << getThroughput(samples.size(), scalarUs) << "MB/s" << std::endl
+        << "Run detection (bit): " << getThroughput(samples.size(), packedUs)
+        << "MB/s" << std::endl;
+
+    return true;
+}
+
+/**
+ * The dump is analyzed like by the inspection command, once sequentially and
+ * once by one thread per CPU core. The results of both are verified to be
+ * identical. The throughput is related to the number of samples.
+ *
+ * @return Status of the operation.
+ */
+bool Benchmark::benchmarkAnalysis(void) const {
+    // Frames are separated like for replays
+    ReplayParameters replayParameters(configuration_);
+    if (!replayParameters.load()) {
+        return false;
+    }
+
+    const uint32_t threads = std::max(std::thread::hardware_concurrency(),
+        1U);
+    DumpAnalysis sequential(dumpFile_, replayParameters.getFrameGap());
+    uint64_t startUs = Clock::now();
+    if (!sequential.analyze(1U)) {
+        return false;
+    }
+    const uint64_t sequentialUs = Clock::now() - startUs;
+
+    DumpAnalysis parallel(dumpFile_, replayParameters.getFrameGap());
+    startUs = Clock::now();
+    if (!parallel.analyze(threads)) {
+        return false;
+    }
+    const uint64_t parallelUs = Clock::now() - startUs;
+
+    if (!(parallel.getStatistics() == sequential.getStatistics())) {
+        std::cerr << "Error: Parallel analysis differs from the sequential "
+            "analysis" << std::endl;
+        return false;
+    }
+
+    const uint64_t samples = sequential.getStatistics().samples;
+    std::cout << "Analysis (1 thread): " << getThroughput(samples,
+        sequentialUs) << "MB/s" << std::endl
+        << "Analysis (parallel): " << getThroughput(samples, parallelUs)
+        << "MB/s (" << threads << " threads, speedup "
+        << static_cast<double>(sequentialUs)
+        / std::max<uint64_t>(parallelUs, 1U) << ")" << std::endl;
+
+    return true;
+}
+
+/**
+ * The throughput is related to the size of the raw sample data, i.e. one
+ * byte per sample.
+ *
+ * @return Status of the operation.
+ */
+bool Benchmark::benchmarkCompression(void) const {
+    std::string outputFile = outputFile_;
+
+    // Use a temporary file if the compressed dump will be discarded
+    if (outputFile.length() == 0U) {
+        char fileName[] = "/tmp/aircontrol-XXXXXX";
+        const int fd = mkstemp(fileName);
+        if (fd < 0) {
+            std::cerr << "Error: Unable to create temporary file: "
+                << strerror(errno) << std::endl;
+            return false;
+        }
+        close(fd);
+        outputFile = fileName;
+    }
+
+    // Compress
+    uint64_t samples = 0U;
+    uint64_t startUs = Clock::now();
+    DumpWriter writer(outputFile, true);
+    bool isSuccessful = writer.open(samplingRateUs_);
+    for (auto i = 0U; isSuccessful && (i < runs_.size()); i++) {
+        isSuccessful = writer.write(runs_[i]);
+        samples += runs_[i].samples;
+    }
+    isSuccessful = isSuccessful && writer.close();
+    const uint64_t compressionUs = Clock::now() - startUs;
+
+    // Decompress and verify
+    startUs = Clock::now();
+    DumpReader reader(outputFile);
+    std::vector<Types::Run> runs;
+    isSuccessful = isSuccessful && reader.open();
+    Types::Run run;
+    while (isSuccessful && reader.read(run)) {
+        runs.push_back(run);
+    }
+    const uint64_t decompressionUs = Clock::now() - startUs;
+    isSuccessful = isSuccessful && !reader.hasFailed();
+
+    const uint64_t compressedSize = getFileSize(outputFile);
+    if (outputFile_.length() == 0U) {
+        unlink(outputFile.c_str());
+    }
+    if (!isSuccessful) {
+        return false;
+    }
+
+    bool isIdentical = runs.size() == runs_.size();
+    for (auto i = 0U; isIdentical && (i < runs.size()); i++) {
+        isIdentical = (runs[i].level == runs_[i].level)
+            && (runs[i].samples == runs_[i].samples);
+    }
+    if (!isIdentical) {
+        std::cerr << "Error: Decompressed air scan dump differs from the "
+            "original" << std::endl;
+        return false;
+    }
+
+    const uint64_t rawSize = samples + sizeof(Types::DUMP_SIGNATURE)
+        + sizeof(samplingRateUs_);
+    std::cout << "Raw size:            " << rawSize << " bytes" << std::endl
+        << "Compressed size:     " << compressedSize << " bytes" << std::endl
+        << "Compression ratio:   "
+        << static_cast<double>(rawSize) / compressedSize << ":1" << std::endl
+        << "Compression:         " << getThroughput(samples, compressionUs)
+        << "MB/s" << std::endl
+        << "Decompression:       " << getThroughput(samples, decompressionUs)
+        << "MB/s" << std::endl;
+
+    if (outputFile_.length() != 0U) {
+        std::cout << "Compressed air scan dump written successfully to file '"
+            << outputFile_ << "'." << std::endl;
+    }
+
+    return true;
+}
+
+/**
+ * @param a First runs.
+ * @param b Second runs.
+ * @return True if both contain the same runs, false otherwise.
+ */
+bool Benchmark::isEqual(const std::vector<Types::Run> & a,
+        const std::vector<Types::Run> & b) {
+    return (a.size() == b.size()) && std::equal(a.begin(), a.end(), b.begin(),
+        [](const Types::Run & x, const Types::Run & y) {
+        return (x.level == y.level) && (x.samples == y.samples);
+    });
+}
+
+/**
+ * @param fileName Name of the file.
+ * @return Size of the file, 0 if it cannot be found.
+ */
+uint64_t Benchmark::getFileSize(const std::string & fileName) {
+    struct stat status;
+
+    if (stat(fileName.c_str(), &status) != 0) {
+        return 0U;
+    }
+
+    return static_cast<uint64_t>(status.st_size);
+}
+
+/**
+ * @param bytes Number of processed bytes.
+ * @param durationUs Processing duration (unit: microseconds).
+ * @return Throughput in megabytes per second.
+ */
+double Benchmark::getThroughput(const uint64_t bytes,
+        const uint64_t durationUs) {
+    return static_cast<double>(bytes) / std::max<uint64_t>(durationUs, 1U);
+}
@@ -0,0 +1,50 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cerrno>
+#include <time.h>
+
+#include "Clock.h"
+
+/// @return Current monotonic time.
+uint64_t Clock::now(void) {
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return static_cast<uint64_t>(time.tv_sec) * MICROSECONDS_PER_SECOND
+        + static_cast<uint64_t>(time.tv_nsec) / NANOSECONDS_PER_MICROSECOND;
+}
+
+/**
+ * Sleeping to an absolute time instead of a relative period prevents the
+ * errors of consecutive sleeps from accumulating.
+ *
+ * @param timeUs Absolute monotonic time to sleep until.
+ */
+void Clock::sleepUntil(const uint64_t timeUs) {
+    struct timespec time;
+
+    time.tv_sec = static_cast<time_t>(timeUs / MICROSECONDS_PER_SECOND);
+    time.tv_nsec = static_cast<long>((timeUs % MICROSECONDS_PER_SECOND)
+        * NANOSECONDS_PER_MICROSECOND);
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &time, nullptr)
+        == EINTR);
+}
@@ -29,6 +29,11 @@ void Configuration::setLocation(const std::string & location) {
     location_ = location;
 }
 
+/// @return Configuration file location.
+const std::string & Configuration::getLocation(void) const {
+    return location_;
+}
+
 /// @return True if the configuration has been loaded, false otherwise.
 bool Configuration::load(void) {
     assert(!isLoaded_);
@@ -64,3 +69,34 @@ bool Configuration::isValidSection(const std::string section) const {
         return false;
     }
 }
+
+/// @return Names of all sections in order of their definition.
+std::vector<std::string> Configuration::getSections(void) const {
+    assert(isLoaded_);
+
+    std::vector<std::string> sections;
+    const libconfig::Setting & root = configuration_.getRoot();
+    for (auto i = 0; i < root.getLength(); i++) {
+        if (root[i].isGroup() && (root[i].getName() != nullptr)) {
+            sections.push_back(root[i].getName());
+        }
+    }
+
+    return sections;
+}
+
+/**
+ * @param section Configuration section.
+ * @param name Configuration name.
+ * @return Pointer to the setting or nullptr if it does not exist.
+ */
+const libconfig::Setting * Configuration::getSetting(
+        const std::string section, const std::string name) const {
+    assert(isLoaded_);
+
+    try {
+        return &configuration_.getRoot()[section.c_str()][name.c_str()];
+    } catch (const libconfig::SettingNotFoundException &) {
+        return nullptr;
+    }
+}
@@ -0,0 +1,375 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#include "AirCodeTraits.h"
+#include "Corpus.h"
+#include "ScanParameters.h"
+
+const Corpus::Setting Corpus::SETTINGS[SETTING_COUNT] = {
+    { "airCode", -1, -1, Types::AirCode::MAX - 1 },
+    { "dataLength", 1200, 1, 1000000 },
+    { "syncLength", 4800, 1, 1000000 },
+    { "length", 24, 1, 1000 },
+    { "sendCommand", 5, 1, 1000 },
+    { "sendDelay", 10000, 0, 10000000 },
+    { "gap", 100000, 1, 100000000 },
+    { "jitter", 0, 0, 100000 },
+    { "noise", 0, 0, 1000000 },
+    { "glitches", 0, 0, 1000 },
+    { "seed", 1, 0, INT32_MAX }
+};
+
+/**
+ * @param configuration Reference of the configuration.
+ * @param sizeMb Size of the samples in megabytes, i.e. the size of a raw
+ *               dump.
+ * @param dumpFile File name of the air scan dump.
+ * @param samplingRateUs Delay between two samples or
+ *                       Types::INVALID_PARAMETER to use the sampling rate of
+ *                       the air scan (unit: microseconds).
+ */
+Corpus::Corpus(Configuration & configuration, const uint32_t sizeMb,
+        const std::string & dumpFile, const int32_t samplingRateUs) :
+        Task(configuration),
+        totalSamples_(sizeMb * SAMPLES_PER_MB),
+        dumpFile_(dumpFile),
+        samplingRateUs_(samplingRateUs),
+        settings_(),
+        random_(),
+        writer_(nullptr),
+        run_({ false, 0U }),
+        level_(false),
+        samples_(0U),
+        timeUs_(0U),
+        frames_(0U) {
+    for (const auto & setting : SETTINGS) {
+        settings_[setting.name] = setting.defaultValue;
+    }
+}
+
+/**
+ * @param arguments Generator settings, e.g. jitter=50.
+ * @return True if all arguments are valid, false otherwise.
+ */
+bool Corpus::setArguments(const std::vector<std::string> & arguments) {
+    std::vector<std::string> names;
+
+    for (const auto & argument : arguments) {
+        const size_t position = argument.find('=');
+        if ((position == std::string::npos) || (position == 0U)
+            || (position + 1U == argument.length())) {
+            std::cerr << "Error: Generator setting '" << argument
+                << "' must be given as name=value" << std::endl;
+            return false;
+        }
+
+        const std::string name = argument.substr(0U, position);
+        const auto setting = std::find_if(std::begin(SETTINGS),
+            std::end(SETTINGS), [&name](const Setting & setting) {
+                return name == setting.name;
+            });
+        if (setting == std::end(SETTINGS)) {
+            std::cerr << "Error: Generator setting '" << name
+                << "' is unknown" << std::endl;
+            return false;
+        } else if (std::find(names.begin(), names.end(), name)
+            != names.end()) {
+            std::cerr << "Error: Generator setting '" << name << "' is given "
+                "multiple times" << std::endl;
+            return false;
+        }
+
+        char * end;
+        const long value = std::strtol(argument.c_str() + position + 1U, &end,
+            10);
+        if ((*end != '\0') || (value < setting->minimum)
+            || (value > setting->maximum)) {
+            std::cerr << "Error: Generator setting '" << name << "' must be "
+                "within " << setting->minimum << " and " << setting->maximum
+                << std::endl;
+            return false;
+        }
+        settings_[name] = static_cast<int32_t>(value);
+        names.push_back(name);
+    }
+
+    return true;
+}
+
+/// @return Program exit code.
+int Corpus::start(void) {
+    // GPIO pins are validated without detecting the board revision
+    Task::disableGpio();
+
+    ScanParameters scanParameters(configuration_);
+    if (!scanParameters.load()) {
+        return EXIT_FAILURE;
+    } else if (samplingRateUs_ == Types::INVALID_PARAMETER) {
+        samplingRateUs_ = scanParameters.getSamplingRate();
+    }
+    writer_ = std::make_unique<DumpWriter>(dumpFile_,
+        scanParameters.getCompressDump());
+    if (!writer_->open(samplingRateUs_)) {
+        return EXIT_FAILURE;
+    }
+
+    // Air codes are cycled unless a single one has been selected, each air
+    // command is repeated like by a target and followed by a gap
+    random_.seed(static_cast<uint32_t>(settings_.at("seed")));
+    const int32_t airCode = settings_.at("airCode");
+    const int32_t sendCommand = settings_.at("sendCommand");
+    for (uint64_t command = 0U; samples_ < totalSamples_; command++) {
+        const std::vector<Types::Pulse> pulses = encode(
+            static_cast<Types::AirCode::AirCode_>((airCode >= 0) ? airCode
+            : command % Types::AirCode::MAX));
+        if (!pause(settings_.at("gap"))) {
+            return EXIT_FAILURE;
+        }
+        for (auto n = 0; (n < sendCommand) && (samples_ < totalSamples_);
+                n++) {
+            if (((n != 0) && !pause(settings_.at("sendDelay")))
+                || !transmit(pulses)) {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    if (!writer_->write(run_) || !writer_->close()) {
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Synthetic air scan dump written successfully to file '"
+        << dumpFile_ << "' (" << frames_ << " frames, " << samples_
+        << " samples of " << samplingRateUs_ << "us)." << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @param range Number of possible values, zero for the value 0 only.
+ * @return Random number.
+ *
+ * The raw output of the generator is used since the distributions of the
+ * standard library are implementation defined.
+ */
+uint32_t Corpus::getRandom(const uint32_t range) {
+    return (range == 0U) ? 0U : static_cast<uint32_t>(random_() % range);
+}
+
+/**
+ * @param airCode Air code.
+ * @return Pulses of the encoded air command.
+ *
+ * The air command consists of random data symbols framed by sync symbols
+ * like the air commands of the sample targets: Manchester frames start and
+ * end with a high sync element, Melitec frames start with four sync
+ * elements. The other air codes have no sync symbols.
+ */
+std::vector<Types::Pulse> Corpus::encode(
+        const Types::AirCode::AirCode_ airCode) {
+    const uint32_t TWELFTHS = 12U;
+    const uint32_t dataLengthUs = settings_.at("dataLength");
+    const uint32_t syncLengthUs = settings_.at("syncLength");
+    const AirCodes::Symbols symbols = AirCodes::getSymbols(airCode);
+    std::vector<Types::Pulse> pulses;
+
+    std::string prefix;
+    std::string suffix;
+    switch (airCode) {
+        case Types::AirCode::MANCHESTER:
+            prefix = "S";
+            suffix = "S";
+            break;
+
+        case Types::AirCode::MELITEC:
+            prefix = "SSSS";
+            break;
+
+        default:
+            break;
+    }
+
+    std::string dataSymbols;
+    for (const auto & symbol : symbols) {
+        if (std::none_of(symbol.begin(), symbol.end(),
+            [](const AirSegment & segment) { return segment.isSync; })) {
+            dataSymbols += symbol.character;
+        }
+    }
+
+    std::string command = prefix;
+    for (auto n = 0; n < settings_.at("length"); n++) {
+        command += dataSymbols[getRandom(
+            static_cast<uint32_t>(dataSymbols.length()))];
+    }
+    command += suffix;
+
+    for (const auto character : command) {
+        const AirSymbol & symbol = *std::find_if(symbols.begin(),
+            symbols.end(), [character](const AirSymbol & candidate) {
+                return candidate.character == character;
+            });
+        for (const auto & segment : symbol) {
+            const uint32_t durationUs = (segment.isSync ? syncLengthUs
+                : dataLengthUs) * segment.twelfths / TWELFTHS;
+            if (!pulses.empty() && (pulses.back().level == segment.level)) {
+                pulses.back().durationUs += durationUs;
+            } else {
+                pulses.push_back({ segment.level, durationUs });
+            }
+        }
+    }
+
+    return pulses;
+}
+
+/**
+ * @param pulses Pulses of the encoded air command.
+ * @return Status of the operation.
+ *
+ * Each edge is shifted by its own random offset within the jitter, i.e. the
+ * jitter does not accumulate. Glitches invert the level of a single sample
+ * within a pulse.
+ */
+bool Corpus::transmit(const std::vector<Types::Pulse> & pulses) {
+    const int32_t jitterUs = settings_.at("jitter");
+    const uint32_t glitches = settings_.at("glitches");
+    const uint64_t glitchUs = samplingRateUs_;
+    const uint32_t PER_MILLE = 1000U;
+    uint64_t intendedUs = timeUs_;
+    int64_t offsetUs = 0;
+
+    for (const auto & pulse : pulses) {
+        const int64_t nextOffsetUs = static_cast<int64_t>(getRandom(2U
+            * jitterUs + 1U)) - jitterUs;
+        const uint64_t durationUs = static_cast<uint64_t>(std::max<int64_t>(
+            1, pulse.durationUs + nextOffsetUs - offsetUs));
+        offsetUs += durationUs - pulse.durationUs;
+
+        bool isSuccess;
+        if ((glitches != 0U) && (getRandom(PER_MILLE) < glitches)
+            && (durationUs > 3U * glitchUs)) {
+            const uint64_t splitUs = glitchUs + getRandom(
+                static_cast<uint32_t>(durationUs - 3U * glitchUs));
+            isSuccess = emit(pulse.level, splitUs, intendedUs)
+                && emit(!pulse.level, glitchUs, timeUs_)
+                && emit(pulse.level, durationUs - splitUs - glitchUs,
+                timeUs_);
+        } else {
+            isSuccess = emit(pulse.level, durationUs, intendedUs);
+        }
+        if (!isSuccess) {
+            return false;
+        }
+        intendedUs += pulse.durationUs;
+    }
+
+    // Transmissions cut short by the end of the dump are not counted
+    if ((timeUs_ + samplingRateUs_ - 1U) / samplingRateUs_ <= totalSamples_) {
+        frames_++;
+    }
+
+    return true;
+}
+
+/**
+ * @param durationUs Duration of the silence (unit: microseconds).
+ * @return Status of the operation.
+ *
+ * Noise pulses up to half the data length are injected at random intervals,
+ * on average the given number of pulses per second.
+ */
+bool Corpus::pause(const uint64_t durationUs) {
+    const uint32_t MICROSECONDS_PER_SECOND = 1000000U;
+    const uint32_t noise = settings_.at("noise");
+    uint64_t remainingUs = durationUs;
+
+    if (noise != 0U) {
+        const uint32_t intervalUs = std::max(1U, MICROSECONDS_PER_SECOND
+            / noise);
+        const uint32_t noiseUs = std::max<uint32_t>(1U,
+            settings_.at("dataLength") / 2);
+        for (;;) {
+            const uint64_t silenceUs = getRandom(2U * intervalUs);
+            const uint64_t pulseUs = 1U + getRandom(noiseUs);
+            if (silenceUs + pulseUs >= remainingUs) {
+                break;
+            } else if (!emit(false, silenceUs, timeUs_)
+                || !emit(true, pulseUs, timeUs_)) {
+                return false;
+            }
+            remainingUs -= silenceUs + pulseUs;
+        }
+    }
+
+    return emit(false, remainingUs, timeUs_);
+}
+
+/**
+ * @param level Signal level, true for a high signal.
+ * @param durationUs Duration of the pulse (unit: microseconds).
+ * @param intendedUs Intended time of the pulse, recorded by the edge trace
+ *                   (unit: microseconds).
+ * @return Status of the operation.
+ *
+ * Sample n is taken at n times the sampling rate, the dump ends after the
+ * requested number of samples.
+ */
+bool Corpus::emit(const bool level, const uint64_t durationUs,
+        const uint64_t intendedUs) {
+    const auto getSample = [this](const uint64_t timeUs) {
+        return (timeUs + samplingRateUs_ - 1U) / samplingRateUs_;
+    };
+
+    if ((trace_ != nullptr) && (level != level_)) {
+        trace_->record(intendedUs, timeUs_, level);
+    }
+    level_ = level;
+    uint64_t samples = std::min(getSample(timeUs_ + durationUs)
+        - getSample(timeUs_), totalSamples_ - samples_);
+    timeUs_ += durationUs;
+    if (samples == 0U) {
+        return true;
+    }
+    samples_ += samples;
+
+    if (level != run_.level) {
+        if (!writer_->write(run_)) {
+            return false;
+        }
+        run_ = { level, 0U };
+    }
+    while (samples > 0U) {
+        if (run_.samples == UINT32_MAX) {
+            if (!writer_->write(run_)) {
+                return false;
+            }
+            run_.samples = 0U;
+        }
+        const uint32_t count = static_cast<uint32_t>(std::min<uint64_t>(
+            samples, UINT32_MAX - run_.samples));
+        run_.samples += count;
+        samples -= count;
+    }
+
+    return true;
+}
@@ -0,0 +1,425 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <fstream>
+#include <sys/stat.h>
+#include <thread>
+
+#include "DumpAnalysis.h"
+#include "DumpReader.h"
+
+/**
+ * @param other Statistics to compare with.
+ * @return True if both statistics are equal, false otherwise.
+ */
+bool DumpAnalysis::Statistics::operator==(const Statistics & other) const {
+    return (samples == other.samples) && (highSamples == other.highSamples)
+        && (edges == other.edges) && (frames == other.frames)
+        && (histogram == other.histogram);
+}
+
+/**
+ * @param dumpFile File name of the air scan dump.
+ * @param frameGapUs Minimum silence period separating two frames (unit:
+ *                   microseconds).
+ */
+DumpAnalysis::DumpAnalysis(const std::string & dumpFile,
+        const int32_t frameGapUs) :
+        dumpFile_(dumpFile),
+        frameGapUs_(frameGapUs),
+        isCompressed_(false),
+        samplingRateUs_(Types::INVALID_PARAMETER),
+        gapSamples_(0U),
+        statistics_(),
+        detector_(nullptr),
+        run_({ false, 0U }),
+        pulse_({ false, 0U }),
+        pulses_(0U) {
+    assert(frameGapUs > 0);
+}
+
+/**
+ * Chunks are analyzed in batches, each batch is stitched once all of its
+ * chunks have been analyzed. This limits the memory required for chunks
+ * without silence gaps.
+ *
+ * @param threads Number of threads, 1 for a sequential pass.
+ * @return Status of the operation.
+ */
+bool DumpAnalysis::analyze(const uint32_t threads) {
+    assert(threads > 0U);
+    assert(detector_ == nullptr);
+
+    DumpReader reader(dumpFile_);
+    if (!reader.open()) {
+        return false;
+    }
+    isCompressed_ = reader.isCompressed();
+    samplingRateUs_ = reader.getSamplingRate();
+    gapSamples_ = (frameGapUs_ + samplingRateUs_ - 1) / samplingRateUs_;
+    detector_ = std::make_unique<FrameDetector>(samplingRateUs_, frameGapUs_);
+
+    std::vector<Chunk> chunks;
+    if (!split(reader.getDataOffset(), threads, chunks)) {
+        return false;
+    }
+
+    const size_t batchSize = threads * CHUNKS_PER_THREAD;
+    for (size_t batch = 0U; batch < chunks.size(); batch += batchSize) {
+        const size_t count = std::min(batchSize, chunks.size() - batch);
+        execute(count, threads, [&](const size_t i) {
+            analyzeChunk(chunks[batch + i]);
+        });
+
+        for (size_t i = batch; i < batch + count; i++) {
+            if (chunks[i].hasFailed) {
+                return false;
+            }
+            stitch(chunks[i]);
+            chunks[i].head = std::vector<Types::Run>();
+            chunks[i].tail = std::vector<Types::Run>();
+        }
+    }
+
+    // Complete the last run and pulse
+    flushRun();
+    Types::Frame frame;
+    if (detector_->finish(frame)) {
+        statistics_.frames++;
+    }
+    if (pulse_.samples != 0U) {
+        addPulse(pulse_, statistics_.histogram);
+        pulses_++;
+    }
+    statistics_.edges = (pulses_ == 0U) ? 0U : pulses_ - 1U;
+
+    return true;
+}
+
+/// @return True if the dump file is compressed, false otherwise.
+bool DumpAnalysis::isCompressed(void) const {
+    return isCompressed_;
+}
+
+/// @return Delay between two dump samples.
+int32_t DumpAnalysis::getSamplingRate(void) const {
+    assert(samplingRateUs_ != Types::INVALID_PARAMETER);
+    return samplingRateUs_;
+}
+
+/// @return Statistics of the air scan dump.
+const DumpAnalysis::Statistics & DumpAnalysis::getStatistics(void) const {
+    return statistics_;
+}
+
+/**
+ * Raw dumps are split at fixed offsets. Compressed dumps are split at the
+ * first run boundary after each fixed offset, the runs of all chunks are
+ * counted to derive the signal level of their first runs.
+ *
+ * @param dataOffset File offset of the sample data.
+ * @param threads Number of threads.
+ * @param chunks Place to store the chunks to.
+ * @return Status of the operation.
+ */
+bool DumpAnalysis::split(const uint64_t dataOffset, const uint32_t threads,
+        std::vector<Chunk> & chunks) const {
+    struct stat status;
+    if (stat(dumpFile_.c_str(), &status) != 0) {
+        return false;
+    }
+    const uint64_t fileSize = std::max<uint64_t>(status.st_size, dataOffset);
+
+    const size_t count = std::max<uint64_t>(1U,
+        (fileSize - dataOffset + CHUNK_SIZE - 1U) / CHUNK_SIZE);
+    chunks.resize(count);
+    for (size_t i = 0U; i < count; i++) {
+        chunks[i] = Chunk();
+        chunks[i].begin = dataOffset + i * CHUNK_SIZE;
+    }
+    if (isCompressed_) {
+        execute(count - 1U, threads, [&](const size_t i) {
+            chunks[i + 1U].begin = align(chunks[i + 1U].begin);
+        });
+    }
+    for (size_t i = 0U; i < count; i++) {
+        chunks[i].end = (i + 1U < count) ? chunks[i + 1U].begin : fileSize;
+    }
+
+    if (isCompressed_) {
+        std::vector<uint64_t> runs(count);
+        execute(count, threads, [&](const size_t i) {
+            runs[i] = countRuns(chunks[i].begin, chunks[i].end);
+        });
+        for (size_t i = 1U; i < count; i++) {
+            chunks[i].runs = chunks[i - 1U].runs + runs[i - 1U];
+        }
+    }
+
+    return true;
+}
+
+/**
+ * The analysis of the runs is delayed by one run since the last run may
+ * continue in the next chunk.
+ *
+ * @param chunk Chunk to be analyzed.
+ */
+void DumpAnalysis::analyzeChunk(Chunk & chunk) const {
+    DumpReader reader(dumpFile_);
+    if (!reader.open() || !reader.seek(chunk.begin, chunk.end, chunk.runs)) {
+        chunk.hasFailed = true;
+        return;
+    }
+
+    FrameDetector detector(samplingRateUs_, frameGapUs_);
+    Types::Frame frame;
+    Pulse pulse = { false, 0U };
+    Types::Run previous = { false, 0U };
+    Types::Run run;
+    while (reader.read(run)) {
+        chunk.samples += run.samples;
+        if (run.level) {
+            chunk.highSamples += run.samples;
+        }
+
+        // Pulses between the first and the last pulse are complete
+        if ((pulse.samples != 0U) && (run.level != pulse.level)) {
+            if (chunk.first.samples == 0U) {
+                chunk.first = pulse;
+            } else {
+                addPulse(pulse, chunk.histogram);
+                chunk.pulses++;
+            }
+            pulse.samples = 0U;
+        }
+        pulse.level = run.level;
+        pulse.samples += run.samples;
+
+        // Frames between the first and the last silence gap are complete
+        if (previous.samples == 0U) {
+            // Do nothing
+        } else if (!chunk.hasGap) {
+            chunk.head.push_back(previous);
+            chunk.hasGap = isGap(previous);
+        } else {
+            if (detector.add(previous, frame)) {
+                chunk.frames++;
+            }
+            if (isGap(previous)) {
+                chunk.tail.clear();
+            } else {
+                chunk.tail.push_back(previous);
+            }
+        }
+        previous = run;
+    }
+    chunk.hasFailed = reader.hasFailed();
+
+    if (chunk.first.samples == 0U) {
+        chunk.first = pulse;
+    } else {
+        chunk.last = pulse;
+    }
+    chunk.lastRun = previous;
+}
+
+/**
+ * Raw runs split by chunk boundaries are merged again, compressed chunks are
+ * split at run boundaries.
+ *
+ * @param chunk Chunk to be stitched.
+ */
+void DumpAnalysis::stitch(const Chunk & chunk) {
+    if (chunk.lastRun.samples == 0U) {
+        return;
+    }
+    statistics_.samples += chunk.samples;
+    statistics_.highSamples += chunk.highSamples;
+
+    // Pulses crossing the chunk boundary are merged
+    if ((pulse_.samples != 0U) && (pulse_.level == chunk.first.level)) {
+        pulse_.samples += chunk.first.samples;
+    } else {
+        if (pulse_.samples != 0U) {
+            addPulse(pulse_, statistics_.histogram);
+            pulses_++;
+        }
+        pulse_ = chunk.first;
+    }
+    if (chunk.last.samples != 0U) {
+        addPulse(pulse_, statistics_.histogram);
+        pulses_ += chunk.pulses + 1U;
+        for (auto level = 0U; level < 2U; level++) {
+            for (auto n = 0U; n < HISTOGRAM_BUCKETS; n++) {
+                statistics_.histogram[level][n] += chunk.histogram[level][n];
+            }
+        }
+        pulse_ = chunk.last;
+    }
+
+    // The frame detector is idle after a silence gap, which allows skipping
+    // the frames detected by the chunk
+    for (const auto & run : chunk.head) {
+        addRun(run);
+    }
+    if (chunk.hasGap) {
+        flushRun();
+        statistics_.frames += chunk.frames;
+        for (const auto & run : chunk.tail) {
+            addRun(run);
+        }
+    }
+    addRun(chunk.lastRun);
+}
+
+/**
+ * Runs longer than the maximum run length are split like by DumpReader.
+ *
+ * @param run Next run.
+ */
+void DumpAnalysis::addRun(const Types::Run & run) {
+    if (!isCompressed_ && (run_.samples != 0U) && (run_.level == run.level)) {
+        const uint64_t samples = static_cast<uint64_t>(run_.samples)
+            + run.samples;
+        if (samples <= UINT32_MAX) {
+            run_.samples = static_cast<uint32_t>(samples);
+            return;
+        }
+        run_.samples = UINT32_MAX;
+        flushRun();
+        run_ = { run.level, static_cast<uint32_t>(samples - UINT32_MAX) };
+        return;
+    }
+
+    flushRun();
+    run_ = run;
+}
+
+void DumpAnalysis::flushRun(void) {
+    Types::Frame frame;
+
+    if ((run_.samples != 0U) && detector_->add(run_, frame)) {
+        statistics_.frames++;
+    }
+    run_.samples = 0U;
+}
+
+/**
+ * @param pulse Pulse to be added.
+ * @param histogram Histogram to add the pulse to.
+ */
+void DumpAnalysis::addPulse(const Pulse & pulse,
+        std::array<std::array<uint64_t, HISTOGRAM_BUCKETS>, 2U> & histogram)
+        const {
+    const uint64_t widthUs = pulse.samples * samplingRateUs_;
+    histogram[pulse.level][63U - __builtin_clzll(widthUs)]++;
+}
+
+/**
+ * @param run Run to be checked.
+ * @return True if the run is a silence gap, false otherwise.
+ */
+bool DumpAnalysis::isGap(const Types::Run & run) const {
+    return !run.level && (run.samples >= gapSamples_);
+}
+
+/**
+ * @param offset File offset to start searching at.
+ * @return File offset behind the first byte at or after the given offset - 1
+ *         completing a variable length integer, the file size if there is
+ *         none.
+ */
+uint64_t DumpAnalysis::align(const uint64_t offset) const {
+    std::ifstream file(dumpFile_, std::ios::in | std::ios::binary);
+    uint64_t position = offset - 1U;
+    char data;
+
+    file.seekg(static_cast<std::streamoff>(position));
+    while (file.get(data)) {
+        position++;
+        if ((static_cast<uint8_t>(data) & 0x80U) == 0U) {
+            return position;
+        }
+    }
+
+    return position;
+}
+
+/**
+ * @param begin File offset of the first byte of the range.
+ * @param end File offset behind the last byte of the range.
+ * @return Number of compressed runs, including empty runs.
+ */
+uint64_t DumpAnalysis::countRuns(const uint64_t begin, const uint64_t end)
+        const {
+    const size_t BLOCK_SIZE = 64U * 1024U;
+    std::ifstream file(dumpFile_, std::ios::in | std::ios::binary);
+    std::vector<char> buffer(BLOCK_SIZE);
+    uint64_t runs = 0U;
+
+    file.seekg(static_cast<std::streamoff>(begin));
+    for (uint64_t position = begin; position < end;) {
+        file.read(buffer.data(), std::min<uint64_t>(BLOCK_SIZE,
+            end - position));
+        const size_t size = static_cast<size_t>(file.gcount());
+        if (size == 0U) {
+            break;
+        }
+        for (size_t i = 0U; i < size; i++) {
+            runs += ((static_cast<uint8_t>(buffer[i]) & 0x80U) == 0U) ? 1U
+                : 0U;
+        }
+        position += size;
+    }
+
+    return runs;
+}
+
+/**
+ * @param count Number of indexes.
+ * @param threads Number of threads, the work is executed by the calling
+ *                thread if 1.
+ * @param work Work to be executed for each index.
+ */
+void DumpAnalysis::execute(const size_t count, const uint32_t threads,
+        const std::function<void(size_t)> & work) {
+    std::atomic<size_t> next(0U);
+    const auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) {
+            work(i);
+        }
+    };
+
+    if (threads <= 1U) {
+        worker();
+        return;
+    }
+
+    std::vector<std::thread> pool;
+    for (auto i = 0U; i < std::min<size_t>(threads, count); i++) {
+        pool.emplace_back(worker);
+    }
+    for (auto & thread : pool) {
+        thread.join();
+    }
+}
@@ -0,0 +1,296 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <string.h>
+
+#include "DumpReader.h"
+#include "RunDetector.h"
+
+/// @param dumpFile File name of the air scan dump.
+DumpReader::DumpReader(const std::string & dumpFile) :
+        dumpFileName_(dumpFile),
+        dumpFile_(),
+        buffer_(BLOCK_SIZE),
+        position_(0U),
+        size_(0U),
+        remaining_(UINT64_MAX),
+        dataOffset_(0U),
+        samplingRateUs_(Types::INVALID_PARAMETER),
+        isCompressed_(false),
+        firstLevel_(false),
+        level_(false),
+        hasFailed_(false) {
+    // Do nothing
+}
+
+/**
+ * @return Status of the operation.
+ *
+ * Format of the serialized file:
+ * - [4 bytes] Signature, either Types::DUMP_SIGNATURE for raw or
+ *             Types::DUMP_SIGNATURE_COMPRESSED for compressed sample data
+ * - [4 bytes] Sampling rate (unit: microseconds)
+ *
+ * Raw sample data:
+ * - [n bytes] Sample data, 1 byte each, 0=low / 1=high
+ *
+ * Compressed sample data:
+ * - [1 byte]  Signal level of the first run, 0=low / 1=high
+ * - [n bytes] Number of samples of alternating low and high runs, encoded as
+ *             variable length integers (7 bits per byte, least significant
+ *             group first, most significant bit set if more bytes follow)
+ */
+bool DumpReader::open(void) {
+    assert(dumpFileName_.length() > 0U);
+
+    // Open dump file
+    dumpFile_.open(dumpFileName_, std::ios::in | std::ios::binary);
+    if (!dumpFile_.is_open()) {
+        std::cerr << "Error: Dump file '" << dumpFileName_ << "' cannot be "
+            "opened for reading: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Read signature
+    uint32_t signature;
+    if (!dumpFile_.read(reinterpret_cast<char *>(&signature),
+            sizeof(signature))) {
+        std::cerr << "Error: Unable to read signature from dump file: "
+            << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Check signature
+    if (signature == Types::DUMP_SIGNATURE_COMPRESSED) {
+        isCompressed_ = true;
+    } else if (signature != Types::DUMP_SIGNATURE) {
+        std::cerr << "Error: Given file is not an air scan dump (signature "
+            "mismatch)" << std::endl;
+        return false;
+    }
+
+    // Read sampling rate
+    if (!dumpFile_.read(reinterpret_cast<char *>(&samplingRateUs_),
+            sizeof(samplingRateUs_))) {
+        std::cerr << "Error: Unable to read sampling rate from dump file: "
+            << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Check sampling rate
+    if (samplingRateUs_ <= 0) {
+        std::cerr << "Error: Given air scan dump seems corrupted (invalid "
+            "sampling rate " << samplingRateUs_ << ")" << std::endl;
+        return false;
+    }
+
+    // Read the signal level of the first compressed run
+    if (isCompressed_) {
+        char level;
+        if (!dumpFile_.read(&level, sizeof(level))) {
+            std::cerr << "Error: Given air scan dump seems corrupted (no data "
+                "elements found)" << std::endl;
+            return false;
+        } else if ((level < 0) || (level > 1)) {
+            std::cerr << "Error: Given air scan dump seems corrupted (invalid "
+                "data value " << +level << ")" << std::endl;
+            return false;
+        }
+        firstLevel_ = (level == 1);
+        level_ = firstLevel_;
+    }
+    dataOffset_ = static_cast<uint64_t>(dumpFile_.tellg());
+
+    return true;
+}
+
+/**
+ * Subsequent reads return the runs within the given range of the sample data
+ * only, i.e. dumps can be read in chunks. Raw runs crossing the boundaries of
+ * the range are split. Compressed ranges must start and end at run
+ * boundaries.
+ *
+ * @param begin File offset of the first byte of the range.
+ * @param end File offset behind the last byte of the range.
+ * @param runs Number of compressed runs preceding the range, including empty
+ *             runs. Ignored for raw dumps.
+ * @return Status of the operation.
+ */
+bool DumpReader::seek(const uint64_t begin, const uint64_t end,
+        const uint64_t runs) {
+    assert(dumpFile_.is_open());
+    assert((begin >= dataOffset_) && (begin <= end));
+
+    dumpFile_.clear();
+    if (!dumpFile_.seekg(static_cast<std::streamoff>(begin))) {
+        std::cerr << "Error: Unable to seek within dump file: "
+            << strerror(errno) << std::endl;
+        hasFailed_ = true;
+        return false;
+    }
+    position_ = 0U;
+    size_ = 0U;
+    remaining_ = end - begin;
+    level_ = (firstLevel_ != ((runs % 2U) != 0U));
+
+    return true;
+}
+
+/// @return Delay between two dump samples.
+int32_t DumpReader::getSamplingRate(void) const {
+    assert(samplingRateUs_ != Types::INVALID_PARAMETER);
+    return samplingRateUs_;
+}
+
+/// @return File offset of the sample data.
+uint64_t DumpReader::getDataOffset(void) const {
+    assert(dumpFile_.is_open());
+    return dataOffset_;
+}
+
+/// @return True if the dump file is compressed, false otherwise.
+bool DumpReader::isCompressed(void) const {
+    return isCompressed_;
+}
+
+/**
+ * @param run Place to store the run to.
+ * @return True if a run has been read, false at the end of the dump file or
+ *         on errors (see hasFailed()).
+ */
+bool DumpReader::read(Types::Run & run) {
+    assert(dumpFile_.is_open());
+
+    if (hasFailed_) {
+        return false;
+    }
+
+    return isCompressed_ ? readCompressed(run) : readRaw(run);
+}
+
+/// @return True if reading failed due to an error, false otherwise.
+bool DumpReader::hasFailed(void) const {
+    return hasFailed_;
+}
+
+/// @return True if unread data is available, false otherwise.
+bool DumpReader::fill(void) {
+    if (position_ < size_) {
+        return true;
+    }
+
+    dumpFile_.read(buffer_.data(), std::min<uint64_t>(buffer_.size(),
+        remaining_));
+    size_ = static_cast<size_t>(dumpFile_.gcount());
+    position_ = 0U;
+    remaining_ -= size_;
+
+    if (dumpFile_.bad()) {
+        std::cerr << "Error: Unable to read data from dump file: "
+            << strerror(errno) << std::endl;
+        hasFailed_ = true;
+        return false;
+    }
+
+    return size_ > 0U;
+}
+
+/**
+ * @param run Place to store the run to.
+ * @return True if a run has been read, false otherwise.
+ */
+bool DumpReader::readRaw(Types::Run & run) {
+    if (!fill()) {
+        return false;
+    }
+
+    const char data = buffer_[position_];
+    if ((data < 0) || (data > 1)) {
+        std::cerr << "Error: Given air scan dump seems corrupted (invalid "
+            "data value " << +data << ")" << std::endl;
+        hasFailed_ = true;
+        return false;
+    }
+
+    // Count the samples of the run, which may span multiple blocks
+    run.level = (data == 1);
+    run.samples = 0U;
+    do {
+        const size_t count = std::min<size_t>(
+            RunDetector::findTransition(
+            reinterpret_cast<const uint8_t *>(&buffer_[position_]),
+            size_ - position_, static_cast<uint8_t>(data)),
+            UINT32_MAX - run.samples);
+        position_ += count;
+        run.samples += static_cast<uint32_t>(count);
+    } while ((position_ == size_) && (run.samples < UINT32_MAX) && fill());
+
+    return !hasFailed_;
+}
+
+/**
+ * @param run Place to store the run to.
+ * @return True if a run has been read, false otherwise.
+ */
+bool DumpReader::readCompressed(Types::Run & run) {
+    const uint32_t MAX_SHIFT = 28U;
+
+    do {
+        uint64_t samples = 0U;
+        uint32_t shift = 0U;
+        uint8_t data;
+
+        do {
+            if (!fill()) {
+                if (shift != 0U) {
+                    std::cerr << "Error: Given air scan dump seems corrupted "
+                        "(truncated data)" << std::endl;
+                    hasFailed_ = true;
+                }
+                return false;
+            } else if (shift > MAX_SHIFT) {
+                std::cerr << "Error: Given air scan dump seems corrupted "
+                    "(invalid run length)" << std::endl;
+                hasFailed_ = true;
+                return false;
+            }
+
+            data = static_cast<uint8_t>(buffer_[position_++]);
+            samples |= static_cast<uint64_t>(data & 0x7FU) << shift;
+            shift += 7U;
+        } while ((data & 0x80U) != 0U);
+
+        if (samples > UINT32_MAX) {
+            std::cerr << "Error: Given air scan dump seems corrupted (invalid "
+                "run length)" << std::endl;
+            hasFailed_ = true;
+            return false;
+        }
+
+        // Empty runs only toggle the signal level
+        run.level = level_;
+        run.samples = static_cast<uint32_t>(samples);
+        level_ = !level_;
+    } while (run.samples == 0U);
+
+    return true;
+}
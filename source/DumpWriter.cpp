@@ -0,0 +1,157 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <string.h>
+
+#include "DumpWriter.h"
+
+/**
+ * @param dumpFile File name of the air scan dump.
+ * @param compress True to write a compressed dump, false for raw samples.
+ */
+DumpWriter::DumpWriter(const std::string & dumpFile, const bool compress) :
+        dumpFileName_(dumpFile),
+        compress_(compress),
+        dumpFile_(),
+        buffer_(),
+        hasRuns_(false),
+        level_(false) {
+    buffer_.reserve(BLOCK_SIZE);
+}
+
+/**
+ * @param samplingRateUs Delay between two dump samples (unit: microseconds).
+ * @return Status of the operation.
+ *
+ * See DumpReader::open() for the format of the serialized file.
+ */
+bool DumpWriter::open(const int32_t samplingRateUs) {
+    assert(dumpFileName_.length() > 0U);
+
+    // Open dump file
+    dumpFile_.open(dumpFileName_, std::ios::out | std::ios::binary
+        | std::ios::trunc);
+    if (!dumpFile_.is_open()) {
+        std::cerr << "Error: Dump file '" << dumpFileName_ << "' cannot be "
+            "opened for writing: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Write signature
+    const uint32_t signature = compress_ ? Types::DUMP_SIGNATURE_COMPRESSED
+        : Types::DUMP_SIGNATURE;
+    if (!dumpFile_.write(reinterpret_cast<const char *>(&signature),
+            sizeof(signature))) {
+        std::cerr << "Error: Unable to write signature to dump file: "
+            << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Write sampling rate
+    if (!dumpFile_.write(reinterpret_cast<const char *>(&samplingRateUs),
+            sizeof(samplingRateUs))) {
+        std::cerr << "Error: Unable to write sampling rate to dump file: "
+            << strerror(errno) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @param run Run of samples to be written.
+ * @return Status of the operation.
+ */
+bool DumpWriter::write(const Types::Run & run) {
+    assert(dumpFile_.is_open());
+
+    if (run.samples == 0U) {
+        return true;
+    }
+
+    if (compress_) {
+        if (!hasRuns_) {
+            buffer_.push_back(static_cast<char>(run.level));
+        } else if (run.level == level_) {
+            // Consecutive runs with the same level are separated by an empty
+            // run of the opposite level
+            appendVarint(0U);
+        }
+        appendVarint(run.samples);
+    } else {
+        uint32_t samples = run.samples;
+        while (samples > 0U) {
+            const size_t count = std::min<size_t>(samples,
+                BLOCK_SIZE - buffer_.size());
+            buffer_.insert(buffer_.end(), count, static_cast<char>(run.level));
+            samples -= static_cast<uint32_t>(count);
+
+            if ((buffer_.size() >= BLOCK_SIZE) && !flush()) {
+                return false;
+            }
+        }
+    }
+
+    hasRuns_ = true;
+    level_ = run.level;
+
+    return (buffer_.size() < BLOCK_SIZE) || flush();
+}
+
+/// @return Status of the operation.
+bool DumpWriter::close(void) {
+    assert(dumpFile_.is_open());
+
+    if (!flush()) {
+        return false;
+    }
+
+    dumpFile_.close();
+    if (dumpFile_.fail()) {
+        std::cerr << "Error: Unable to write data to dump file: "
+            << strerror(errno) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/// @return Status of the operation.
+bool DumpWriter::flush(void) {
+    if (!dumpFile_.write(buffer_.data(), buffer_.size())) {
+        std::cerr << "Error: Unable to write data to dump file: "
+            << strerror(errno) << std::endl;
+        return false;
+    }
+    buffer_.clear();
+
+    return true;
+}
+
+/// @param value Value to be appended.
+void DumpWriter::appendVarint(uint32_t value) {
+    while (value >= 0x80U) {
+        buffer_.push_back(static_cast<char>((value & 0x7FU) | 0x80U));
+        value >>= 7U;
+    }
+    buffer_.push_back(static_cast<char>(value));
+}
@@ -0,0 +1,162 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <iostream>
+
+#include "EncodingParameters.h"
+
+/**
+ * @param configuration Reference of the configuration.
+ * @param name Reference of the encoding name.
+ */
+EncodingParameters::EncodingParameters(const Configuration & configuration,
+        const std::string & name) :
+        configuration_(configuration),
+        name_(name),
+        symbols_() {
+    // Do nothing
+}
+
+/// @return Status of the operation.
+bool EncodingParameters::load(void) {
+    return loadSymbols();
+}
+
+/// @return Name of the encoding.
+const std::string & EncodingParameters::getName(void) const {
+    return name_;
+}
+
+/// @return Symbols of the encoding.
+const std::vector<EncodingParameters::Symbol> &
+        EncodingParameters::getSymbols(void) const {
+    assert(!symbols_.empty());
+    return symbols_;
+}
+
+/// @return Characters of all symbols of the encoding.
+std::string EncodingParameters::getAlphabet(void) const {
+    std::string alphabet;
+
+    for (const auto & symbol : getSymbols()) {
+        alphabet += symbol.character;
+    }
+
+    return alphabet;
+}
+
+/// @return True if successful, false otherwise.
+bool EncodingParameters::loadSymbols(void) {
+    const libconfig::Setting * encoding = configuration_.getSetting(
+        "encodings", name_);
+    if ((encoding == nullptr) || !encoding->isGroup()
+        || !encoding->exists("symbols")) {
+        std::cerr << "Error: Configuration error (encoding " << name_
+            << "): encoding is undefined" << std::endl;
+        return false;
+    }
+
+    const libconfig::Setting & symbols = (*encoding)["symbols"];
+    if (!symbols.isList() || (symbols.getLength() == 0)) {
+        std::cerr << "Error: Configuration error (encoding " << name_
+            << "): symbols must be a non-empty list" << std::endl;
+        return false;
+    }
+
+    for (auto i = 0; i < symbols.getLength(); i++) {
+        if (!loadSymbol(symbols[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @param setting Symbol group, e.g.
+ *                { character = "0"; segments = ( ( 1, 0.25 ), ( 0, 0.75 ) ); }
+ * @return True if successful, false otherwise.
+ */
+bool EncodingParameters::loadSymbol(const libconfig::Setting & setting) {
+    Symbol symbol = { '\0', false, {} };
+    std::string character;
+
+    if (!setting.isGroup() || !setting.lookupValue("character", character)
+        || (character.length() != 1U)) {
+        std::cerr << "Error: Configuration error (encoding " << name_
+            << "): symbol " << symbols_.size() + 1U << " requires a single "
+            "character" << std::endl;
+        return false;
+    }
+    symbol.character = character.front();
+
+    for (const auto & other : symbols_) {
+        if (other.character == symbol.character) {
+            std::cerr << "Error: Configuration error (encoding " << name_
+                << "): symbol '" << symbol.character << "' is defined "
+                "multiple times" << std::endl;
+            return false;
+        }
+    }
+
+    // Fractions refer to the data element length unless declared as sync
+    setting.lookupValue("sync", symbol.isSync);
+
+    if (!setting.exists("segments") || !setting["segments"].isList()
+        || (setting["segments"].getLength() == 0)) {
+        std::cerr << "Error: Configuration error (encoding " << name_
+            << "): symbol '" << symbol.character << "' requires a non-empty "
+            "segments list" << std::endl;
+        return false;
+    }
+
+    const libconfig::Setting & segments = setting["segments"];
+    for (auto i = 0; i < segments.getLength(); i++) {
+        const libconfig::Setting & segment = segments[i];
+
+        // Integer fractions are accepted as well, e.g. ( 0, 1 )
+        if (!segment.isAggregate() || (segment.getLength() != 2)
+            || (segment[0].getType() != libconfig::Setting::TypeInt)
+            || !segment[1].isNumber()) {
+            std::cerr << "Error: Configuration error (encoding " << name_
+                << "): segment " << i + 1 << " of symbol '"
+                << symbol.character << "' must be a pair of level and "
+                "fraction" << std::endl;
+            return false;
+        }
+
+        const int level = segment[0];
+        const double fraction = (segment[1].getType()
+            == libconfig::Setting::TypeFloat) ? static_cast<double>(segment[1])
+            : static_cast<int>(segment[1]);
+        if (((level != 0) && (level != 1)) || (fraction <= 0.0)) {
+            std::cerr << "Error: Configuration error (encoding " << name_
+                << "): segment " << i + 1 << " of symbol '"
+                << symbol.character << "' is invalid" << std::endl;
+            return false;
+        }
+
+        symbol.segments.push_back({ level == 1, fraction });
+    }
+
+    symbols_.push_back(symbol);
+
+    return true;
+}
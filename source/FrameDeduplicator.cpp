@@ -0,0 +1,176 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <iomanip>
+
+#include "FrameDeduplicator.h"
+#include "Signature.h"
+
+/**
+ * @param samplingRateUs Delay between two samples (unit: microseconds).
+ * @param frameGapUs Minimum silence period separating two frames (unit:
+ *                   microseconds).
+ */
+FrameDeduplicator::FrameDeduplicator(const int32_t samplingRateUs,
+        const int32_t frameGapUs) :
+        samplingRateUs_(samplingRateUs),
+        gapSamples_((frameGapUs + samplingRateUs - 1) / samplingRateUs),
+        detector_(samplingRateUs, frameGapUs),
+        position_(0U),
+        pendingStart_(0U),
+        pending_(),
+        entries_(),
+        hashes_(),
+        frames_(0U) {
+    assert(samplingRateUs > 0);
+    assert(frameGapUs > 0);
+}
+
+/**
+ * Only the runs since the last silence gap are kept, frames never span
+ * silence gaps.
+ *
+ * @param run Next run of the stream.
+ */
+void FrameDeduplicator::add(const Types::Run & run) {
+    Types::Frame frame;
+
+    if (detector_.add(run, frame)) {
+        addFrame(frame);
+    }
+
+    position_ += run.samples;
+    if (!run.level && (run.samples >= gapSamples_)) {
+        pending_.clear();
+        pendingStart_ = position_;
+    } else {
+        pending_.push_back(run);
+    }
+}
+
+void FrameDeduplicator::finish(void) {
+    Types::Frame frame;
+
+    if (detector_.finish(frame)) {
+        addFrame(frame);
+    }
+    pending_.clear();
+    pendingStart_ = position_;
+}
+
+/**
+ * One line is printed per unique frame, followed by its pulses: high pulses
+ * prefixed by '+', low pulses by '-' (unit: microseconds).
+ *
+ * @param stream Stream to print the unique frames to.
+ * @param targetIndex Target index to identify the unique frames with or
+ *                    nullptr.
+ */
+void FrameDeduplicator::print(std::ostream & stream,
+        const TargetIndex * targetIndex) const {
+    stream << "Unique frames:  " << entries_.size() << " of " << frames_
+        << std::endl;
+
+    stream << std::fixed << std::setprecision(1);
+    for (auto i = 0U; i < entries_.size(); i++) {
+        const Entry & entry = entries_[i];
+        uint64_t durationUs = 0U;
+        for (const auto & pulse : entry.pulses) {
+            durationUs += pulse.durationUs;
+        }
+
+        stream << "#" << i + 1U << "  repeats " << entry.repeats
+            << "  first " << entry.firstUs / 1000.0 << "ms"
+            << "  last " << entry.lastUs / 1000.0 << "ms"
+            << "  duration " << durationUs / 1000.0 << "ms"
+            << "  pulses " << entry.pulses.size();
+        if (targetIndex != nullptr) {
+            const auto targets = targetIndex->identify(entry.pulses,
+                samplingRateUs_);
+            stream << "  target";
+            for (const auto & target : targets) {
+                stream << " " << target;
+            }
+            if (targets.empty()) {
+                stream << " unknown";
+            }
+        }
+        stream << std::endl << "   ";
+        for (const auto & pulse : entry.pulses) {
+            stream << " " << (pulse.level ? "+" : "-") << pulse.durationUs;
+        }
+        stream << std::endl;
+    }
+}
+
+/**
+ * Adjacent runs of the same level are merged to a single pulse. The frame is
+ * looked up by its signature first, frames whose pulses are clustered
+ * differently are found by comparing them with all unique frames.
+ *
+ * @param frame Frame to be added, must be covered by the pending runs.
+ */
+void FrameDeduplicator::addFrame(const Types::Frame & frame) {
+    std::vector<Types::Pulse> pulses;
+    uint64_t position = pendingStart_;
+
+    for (const auto & run : pending_) {
+        if (position >= frame.offset + frame.samples) {
+            break;
+        } else if (position >= frame.offset) {
+            const uint32_t durationUs = run.samples * samplingRateUs_;
+            if (!pulses.empty() && (pulses.back().level == run.level)) {
+                pulses.back().durationUs += durationUs;
+            } else {
+                pulses.push_back({ run.level, durationUs });
+            }
+        }
+        position += run.samples;
+    }
+    if (pulses.empty()) {
+        return;
+    }
+    frames_++;
+
+    const uint64_t offsetUs = frame.offset * samplingRateUs_;
+    const uint32_t toleranceUs = 2U * samplingRateUs_;
+    const uint64_t hash = Signature::hash(pulses);
+    auto found = hashes_.find(hash);
+    size_t index = entries_.size();
+    if ((found != hashes_.end()) && Signature::isMatching(
+            entries_[found->second].pulses, pulses, toleranceUs)) {
+        index = found->second;
+    } else {
+        for (auto i = 0U; i < entries_.size(); i++) {
+            if (Signature::isMatching(entries_[i].pulses, pulses,
+                    toleranceUs)) {
+                index = i;
+                break;
+            }
+        }
+        hashes_.emplace(hash, index);
+    }
+
+    if (index == entries_.size()) {
+        entries_.push_back({ pulses, 0U, offsetUs, offsetUs });
+    }
+    entries_[index].repeats++;
+    entries_[index].lastUs = offsetUs;
+}
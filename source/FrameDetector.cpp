@@ -0,0 +1,78 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+
+#include "FrameDetector.h"
+
+/**
+ * @param samplingRateUs Delay between two samples (unit: microseconds).
+ * @param frameGapUs Minimum silence period separating two frames (unit:
+ *                   microseconds).
+ */
+FrameDetector::FrameDetector(const int32_t samplingRateUs,
+        const int32_t frameGapUs) :
+        gapSamples_((frameGapUs + samplingRateUs - 1) / samplingRateUs),
+        position_(0U),
+        frameStart_(0U),
+        frameRuns_(0U) {
+    assert(samplingRateUs > 0);
+    assert(frameGapUs > 0);
+}
+
+/**
+ * @param run Next run of the stream.
+ * @param frame Place to store a completed frame to.
+ * @return True if a frame has been completed, false otherwise.
+ */
+bool FrameDetector::add(const Types::Run & run, Types::Frame & frame) {
+    bool isCompleted = false;
+
+    if (!run.level && (run.samples >= gapSamples_)) {
+        if (frameRuns_ >= MIN_FRAME_RUNS) {
+            frame = { frameStart_, position_ - frameStart_ };
+            isCompleted = true;
+        }
+        frameRuns_ = 0U;
+    } else if ((frameRuns_ > 0U) || run.level) {
+        if (frameRuns_ == 0U) {
+            frameStart_ = position_;
+        }
+        frameRuns_++;
+    }
+
+    position_ += run.samples;
+
+    return isCompleted;
+}
+
+/**
+ * @param frame Place to store a completed frame to.
+ * @return True if a frame has been completed, false otherwise.
+ */
+bool FrameDetector::finish(Types::Frame & frame) {
+    const bool isCompleted = frameRuns_ >= MIN_FRAME_RUNS;
+
+    if (isCompleted) {
+        frame = { frameStart_, position_ - frameStart_ };
+    }
+    frameRuns_ = 0U;
+
+    return isCompleted;
+}
@@ -0,0 +1,230 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <iostream>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "FrameDetector.h"
+#include "FrameIndex.h"
+
+const std::string FrameIndex::FILE_EXTENSION = ".idx";
+
+/**
+ * @param dumpFile File name of the air scan dump.
+ * @param samplingRateUs Delay between two dump samples (unit: microseconds).
+ * @param frameGapUs Minimum silence period separating two frames (unit:
+ *                   microseconds).
+ */
+FrameIndex::FrameIndex(const std::string & dumpFile,
+        const int32_t samplingRateUs, const int32_t frameGapUs) :
+        indexFile_(dumpFile + FILE_EXTENSION),
+        dumpFile_(dumpFile),
+        samplingRateUs_(samplingRateUs),
+        frameGapUs_(frameGapUs),
+        frames_() {
+    // Do nothing
+}
+
+/// @param runs Runs of the related air scan dump.
+void FrameIndex::update(const std::vector<Types::Run> & runs) {
+    if (load()) {
+        return;
+    }
+
+    frames_ = detect(runs, samplingRateUs_, frameGapUs_);
+
+    // A missing index file only costs another analysis on the next replay
+    if (!save()) {
+        std::cerr << "Warning: Frame index file '" << indexFile_ << "' cannot "
+            "be written: " << strerror(errno) << std::endl;
+    }
+}
+
+/// @return Detected frames.
+const std::vector<Types::Frame> & FrameIndex::getFrames(void) const {
+    return frames_;
+}
+
+/**
+ * @param runs Runs to be analyzed.
+ * @param samplingRateUs Delay between two samples (unit: microseconds).
+ * @param frameGapUs Minimum silence period separating two frames (unit:
+ *                   microseconds).
+ * @return Detected frames.
+ */
+std::vector<Types::Frame> FrameIndex::detect(
+        const std::vector<Types::Run> & runs, const int32_t samplingRateUs,
+        const int32_t frameGapUs) {
+    FrameDetector detector(samplingRateUs, frameGapUs);
+    std::vector<Types::Frame> frames;
+    Types::Frame frame;
+
+    for (const auto & run : runs) {
+        if (detector.add(run, frame)) {
+            frames.push_back(frame);
+        }
+    }
+    if (detector.finish(frame)) {
+        frames.push_back(frame);
+    }
+
+    return frames;
+}
+
+/**
+ * @return Status of the related air scan dump file, all zero if it cannot be
+ *         found.
+ */
+FrameIndex::DumpStatus FrameIndex::getDumpStatus(void) const {
+    DumpStatus dumpStatus = { 0U, 0 };
+    struct stat status;
+
+    if (stat(dumpFile_.c_str(), &status) != 0) {
+        return dumpStatus;
+    }
+
+    dumpStatus.size = static_cast<uint64_t>(status.st_size);
+    dumpStatus.modifiedNs = static_cast<int64_t>(status.st_mtim.tv_sec)
+        * 1000000000 + status.st_mtim.tv_nsec;
+    return dumpStatus;
+}
+
+/**
+ * @return True if the index file is valid and matches the dump, false
+ *         otherwise.
+ *
+ * Format of the serialized file:
+ * - [4 bytes] Signature
+ * - [8 bytes] Size of the related dump file (unit: bytes)
+ * - [8 bytes] Modification time of the related dump file (unit: nanoseconds
+ *             since the epoch)
+ * - [4 bytes] Sampling rate of the related dump file (unit: microseconds)
+ * - [4 bytes] Frame gap the frames have been detected with (unit:
+ *             microseconds)
+ * - [4 bytes] Number of frames
+ * - [n * 16 bytes] Frames, 8 bytes offset and 8 bytes samples each
+ */
+bool FrameIndex::load(void) {
+    std::ifstream indexFile;
+
+    indexFile.open(indexFile_, std::ios::in | std::ios::binary);
+    if (!indexFile.is_open()) {
+        return false;
+    }
+
+    uint32_t signature;
+    DumpStatus dumpStatus;
+    int32_t samplingRateUs;
+    int32_t frameGapUs;
+    uint32_t count;
+    if (!indexFile.read(reinterpret_cast<char *>(&signature),
+            sizeof(signature))
+        || !indexFile.read(reinterpret_cast<char *>(&dumpStatus.size),
+            sizeof(dumpStatus.size))
+        || !indexFile.read(reinterpret_cast<char *>(&dumpStatus.modifiedNs),
+            sizeof(dumpStatus.modifiedNs))
+        || !indexFile.read(reinterpret_cast<char *>(&samplingRateUs),
+            sizeof(samplingRateUs))
+        || !indexFile.read(reinterpret_cast<char *>(&frameGapUs),
+            sizeof(frameGapUs))
+        || !indexFile.read(reinterpret_cast<char *>(&count),
+            sizeof(count))) {
+        return false;
+    }
+
+    // Outdated index files are silently replaced, a dump rewritten with the
+    // same size is caught by its modification time
+    const DumpStatus currentStatus = getDumpStatus();
+    if ((signature != Types::INDEX_SIGNATURE)
+        || (dumpStatus.size != currentStatus.size)
+        || (dumpStatus.modifiedNs != currentStatus.modifiedNs)
+        || (samplingRateUs != samplingRateUs_)
+        || (frameGapUs != frameGapUs_)) {
+        return false;
+    }
+
+    // The number of frames must match the remaining file size, a truncated
+    // or corrupted index file must not allocate an arbitrary number of
+    // frames
+    const uint64_t FRAME_SIZE = sizeof(Types::Frame::offset)
+        + sizeof(Types::Frame::samples);
+    const std::streampos position = indexFile.tellg();
+    indexFile.seekg(0, std::ios::end);
+    const std::streampos end = indexFile.tellg();
+    indexFile.seekg(position);
+    if ((position < 0) || (end < position) || !indexFile
+        || (static_cast<uint64_t>(end - position)
+        != static_cast<uint64_t>(count) * FRAME_SIZE)) {
+        return false;
+    }
+
+    std::vector<Types::Frame> frames(count);
+    for (auto & frame : frames) {
+        if (!indexFile.read(reinterpret_cast<char *>(&frame.offset),
+                sizeof(frame.offset))
+            || !indexFile.read(reinterpret_cast<char *>(&frame.samples),
+                sizeof(frame.samples))) {
+            return false;
+        }
+    }
+
+    frames_ = frames;
+    return true;
+}
+
+/// @return True if successful, false otherwise.
+bool FrameIndex::save(void) const {
+    std::ofstream indexFile;
+
+    indexFile.open(indexFile_, std::ios::out | std::ios::binary
+        | std::ios::trunc);
+    if (!indexFile.is_open()) {
+        return false;
+    }
+
+    const DumpStatus dumpStatus = getDumpStatus();
+    const uint32_t count = static_cast<uint32_t>(frames_.size());
+    if (!indexFile.write(reinterpret_cast<const char *>(
+            &Types::INDEX_SIGNATURE), sizeof(Types::INDEX_SIGNATURE))
+        || !indexFile.write(reinterpret_cast<const char *>(&dumpStatus.size),
+            sizeof(dumpStatus.size))
+        || !indexFile.write(reinterpret_cast<const char *>(
+            &dumpStatus.modifiedNs), sizeof(dumpStatus.modifiedNs))
+        || !indexFile.write(reinterpret_cast<const char *>(&samplingRateUs_),
+            sizeof(samplingRateUs_))
+        || !indexFile.write(reinterpret_cast<const char *>(&frameGapUs_),
+            sizeof(frameGapUs_))
+        || !indexFile.write(reinterpret_cast<const char *>(&count),
+            sizeof(count))) {
+        return false;
+    }
+
+    for (const auto & frame : frames_) {
+        if (!indexFile.write(reinterpret_cast<const char *>(&frame.offset),
+                sizeof(frame.offset))
+            || !indexFile.write(reinterpret_cast<const char *>(
+                &frame.samples), sizeof(frame.samples))) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,81 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <wiringPi.h>
+
+#include "GpioBank.h"
+
+/**
+ * /dev/gpiomem is accessible without root privileges on Raspbian, it maps the
+ * GPIO registers only.
+ */
+GpioBank::GpioBank(void) :
+        registers_(nullptr) {
+    const int file = open("/dev/gpiomem", O_RDWR | O_SYNC | O_CLOEXEC);
+    if (file < 0) {
+        return;
+    }
+
+    void * block = mmap(nullptr, BLOCK_SIZE, PROT_READ | PROT_WRITE,
+        MAP_SHARED, file, 0);
+    close(file);
+    if (block != MAP_FAILED) {
+        registers_ = static_cast<volatile uint32_t *>(block);
+    }
+}
+
+GpioBank::~GpioBank(void) {
+    if (registers_ != nullptr) {
+        munmap(const_cast<uint32_t *>(registers_), BLOCK_SIZE);
+    }
+}
+
+/// @return True if the GPIO registers are mapped, false otherwise.
+bool GpioBank::isMapped(void) const {
+    return registers_ != nullptr;
+}
+
+/**
+ * Writing zero bits to the set and clear registers has no effect, i.e. pins
+ * of other processes are not touched.
+ */
+void GpioBank::write(const uint32_t setMask, const uint32_t clearMask)
+        const {
+    if (registers_ != nullptr) {
+        if (setMask != 0U) {
+            registers_[GPSET0] = setMask;
+        }
+        if (clearMask != 0U) {
+            registers_[GPCLR0] = clearMask;
+        }
+        return;
+    }
+
+    for (uint8_t pin = 0U; pin < 32U; pin++) {
+        if ((setMask & (1U << pin)) != 0U) {
+            digitalWrite(pin, HIGH);
+        } else if ((clearMask & (1U << pin)) != 0U) {
+            digitalWrite(pin, LOW);
+        }
+    }
+}
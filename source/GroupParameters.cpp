@@ -0,0 +1,110 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <iostream>
+
+#include "GroupParameters.h"
+#include "Types.h"
+
+/**
+ * @param configuration Reference of the configuration.
+ * @param name Group name, must match an entry of the 'groups' section.
+ */
+GroupParameters::GroupParameters(const Configuration & configuration,
+        const std::string & name) :
+        configuration_(configuration),
+        name_(name),
+        members_() {
+    // Do nothing
+}
+
+/**
+ * @param configuration Reference of the configuration.
+ * @param name Group name.
+ * @return True if the group exists, false otherwise.
+ */
+bool GroupParameters::isGroup(const Configuration & configuration,
+        const std::string & name) {
+    return configuration.getSetting("groups", name) != nullptr;
+}
+
+/// @return Status of the operation.
+bool GroupParameters::load(void) {
+    return loadMembers();
+}
+
+/// @return Members of the group.
+const std::vector<GroupParameters::Member> & GroupParameters::getMembers(
+        void) const {
+    assert(!members_.empty());
+    return members_;
+}
+
+/**
+ * @return True if successful, false otherwise.
+ *
+ * Members are given as a list of target names, each optionally paired with
+ * a gap, e.g. ( "outlet_a", ( "outlet_b", 5000 ) ).
+ */
+bool GroupParameters::loadMembers(void) {
+    const libconfig::Setting * members = configuration_.getSetting("groups",
+        name_);
+    if ((members == nullptr) || !members->isList()
+        || (members->getLength() == 0)) {
+        std::cerr << "Error: Configuration error (group " << name_
+            << "): members must be a non-empty list" << std::endl;
+        return false;
+    }
+
+    for (auto i = 0; i < members->getLength(); i++) {
+        const libconfig::Setting & member = (*members)[i];
+        Member value = { std::string(), Types::INVALID_PARAMETER };
+
+        if (member.getType() == libconfig::Setting::TypeString) {
+            value.name = member.c_str();
+        } else if (member.isAggregate() && (member.getLength() == 2)
+            && (member[0].getType() == libconfig::Setting::TypeString)
+            && (member[1].getType() == libconfig::Setting::TypeInt)) {
+            value.name = member[0].c_str();
+            value.gapUs = static_cast<int>(member[1]);
+        }
+
+        if (value.name.empty()) {
+            std::cerr << "Error: Configuration error (group " << name_
+                << "): member " << i + 1 << " must be a target name or a "
+                "pair of target name and gap" << std::endl;
+            return false;
+        } else if ((value.gapUs != Types::INVALID_PARAMETER)
+            && (value.gapUs < 0)) {
+            std::cerr << "Error: Configuration error (group " << name_
+                << "): gap of member '" << value.name << "' is invalid"
+                << std::endl;
+            return false;
+        } else if (isGroup(configuration_, value.name)) {
+            std::cerr << "Error: Configuration error (group " << name_
+                << "): member '" << value.name << "' must not be a group"
+                << std::endl;
+            return false;
+        }
+        members_.push_back(value);
+    }
+
+    return true;
+}
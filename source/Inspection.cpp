@@ -0,0 +1,264 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "DumpAnalysis.h"
+#include "DumpReader.h"
+#include "FrameDeduplicator.h"
+#include "Inspection.h"
+#include "Learner.h"
+#include "TargetIndex.h"
+
+/**
+ * @param configuration Reference of the configuration.
+ * @param dumpFile File name of the air scan dump.
+ * @param outputFormat Output format of the inspection results.
+ */
+Inspection::Inspection(Configuration & configuration,
+        const std::string & dumpFile,
+        const Types::OutputFormat::OutputFormat_ outputFormat) :
+        Task(configuration),
+        dumpFile_(dumpFile),
+        outputFormat_(outputFormat),
+        parameters_(nullptr),
+        isCompressed_(false),
+        samplingRateUs_(Types::INVALID_PARAMETER),
+        statistics_() {
+    // Do nothing
+}
+
+/// @return Program exit code.
+int Inspection::start(void) {
+    // GPIO pins are validated without detecting the board revision, dumps
+    // can be inspected on any machine
+    Task::disableGpio();
+
+    assert(parameters_ == nullptr);
+    parameters_ = std::make_unique<ReplayParameters>(
+        ReplayParameters(configuration_));
+
+    // Load all parameters from the configuration
+    if (!parameters_->load()) {
+        return EXIT_FAILURE;
+    }
+
+    if (outputFormat_ == Types::OutputFormat::TARGET) {
+        return learn() ? EXIT_SUCCESS : EXIT_FAILURE;
+    } else if ((outputFormat_ == Types::OutputFormat::FRAMES)
+            || (outputFormat_ == Types::OutputFormat::IDENTIFY)) {
+        return deduplicate() ? EXIT_SUCCESS : EXIT_FAILURE;
+    } else if (!inspect()) {
+        return EXIT_FAILURE;
+    }
+
+    switch (outputFormat_) {
+        case Types::OutputFormat::TEXT:
+            printText();
+            break;
+
+        case Types::OutputFormat::JSON:
+            printJson();
+            break;
+
+        case Types::OutputFormat::TARGET:
+            // Intentional fall-through
+
+        case Types::OutputFormat::FRAMES:
+            // Intentional fall-through
+
+        case Types::OutputFormat::IDENTIFY:
+            // Intentional fall-through
+
+        case Types::OutputFormat::MAX:
+        default:
+            assert(false);
+            break;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * The dump is analyzed by one thread per CPU core.
+ *
+ * @return Status of the operation.
+ */
+bool Inspection::inspect(void) {
+    DumpAnalysis analysis(dumpFile_, parameters_->getFrameGap());
+
+    if (!analysis.analyze(std::max(std::thread::hardware_concurrency(), 1U))) {
+        return false;
+    }
+    isCompressed_ = analysis.isCompressed();
+    samplingRateUs_ = analysis.getSamplingRate();
+    statistics_ = analysis.getStatistics();
+
+    if (statistics_.samples == 0U) {
+        std::cerr << "Error: Given air scan dump seems corrupted (no data "
+            "elements found)" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/// @return Status of the operation.
+bool Inspection::learn(void) const {
+    DumpReader reader(dumpFile_);
+
+    if (!reader.open()) {
+        return false;
+    }
+
+    Learner learner(reader.getSamplingRate(), parameters_->getFrameGap());
+    Types::Run run;
+    while (reader.read(run)) {
+        learner.add(run);
+    }
+    if (reader.hasFailed()) {
+        return false;
+    }
+
+    if (!learner.learn()) {
+        std::cerr << "Error: No decodable radio frames found in air scan dump"
+            << std::endl;
+        return false;
+    }
+    learner.print(std::cout, Types::LEARNED_TARGET_NAME);
+
+    return true;
+}
+
+/// @return Status of the operation.
+bool Inspection::deduplicate(void) const {
+    DumpReader reader(dumpFile_);
+
+    if (!reader.open()) {
+        return false;
+    }
+
+    FrameDeduplicator deduplicator(reader.getSamplingRate(),
+        parameters_->getFrameGap());
+    Types::Run run;
+    while (reader.read(run)) {
+        deduplicator.add(run);
+    }
+    if (reader.hasFailed()) {
+        return false;
+    }
+    deduplicator.finish();
+
+    // Unique frames are identified by the configured targets on request
+    if (outputFormat_ == Types::OutputFormat::IDENTIFY) {
+        TargetIndex targetIndex(configuration_);
+        if (!targetIndex.load(parameters_->getFrameGap())) {
+            return false;
+        }
+        deduplicator.print(std::cout, &targetIndex);
+    } else {
+        deduplicator.print(std::cout);
+    }
+
+    return true;
+}
+
+void Inspection::printText(void) const {
+    std::cout << std::fixed << std::setprecision(1)
+        << "Air scan dump:  " << dumpFile_ << std::endl
+        << "Format:         " << (isCompressed_ ? "compressed" : "raw")
+        << std::endl
+        << "Sampling rate:  " << samplingRateUs_ << "us" << std::endl
+        << "Samples:        " << statistics_.samples << std::endl
+        << "Duration:       " << statistics_.samples * samplingRateUs_ / 1000U
+        << "ms" << std::endl
+        << "Duty cycle:     " << getDutyCycle() << "%" << std::endl
+        << "Edges:          " << statistics_.edges << std::endl
+        << "Frames:         " << statistics_.frames << std::endl
+        << "Pulse widths:" << std::endl;
+
+    for (auto n = 0U; n < DumpAnalysis::HISTOGRAM_BUCKETS; n++) {
+        if ((statistics_.histogram[true][n] != 0U)
+                || (statistics_.histogram[false][n] != 0U)) {
+            std::cout << "  >=" << std::setw(10) << (1ULL << n) << "us  high "
+                << std::setw(10) << statistics_.histogram[true][n] << "  low "
+                << std::setw(10) << statistics_.histogram[false][n]
+                << std::endl;
+        }
+    }
+}
+
+void Inspection::printJson(void) const {
+    std::cout << std::fixed << std::setprecision(3)
+        << "{\"dumpFile\":\"" << escapeJson(dumpFile_) << "\""
+        << ",\"compressed\":" << (isCompressed_ ? "true" : "false")
+        << ",\"samplingRate\":" << samplingRateUs_
+        << ",\"samples\":" << statistics_.samples
+        << ",\"durationUs\":" << statistics_.samples * samplingRateUs_
+        << ",\"dutyCycle\":" << getDutyCycle()
+        << ",\"edges\":" << statistics_.edges
+        << ",\"frames\":" << statistics_.frames
+        << ",\"pulseWidths\":[";
+
+    bool isFirst = true;
+    for (auto n = 0U; n < DumpAnalysis::HISTOGRAM_BUCKETS; n++) {
+        if ((statistics_.histogram[true][n] != 0U)
+                || (statistics_.histogram[false][n] != 0U)) {
+            std::cout << (isFirst ? "" : ",") << "{\"minUs\":" << (1ULL << n)
+                << ",\"high\":" << statistics_.histogram[true][n]
+                << ",\"low\":" << statistics_.histogram[false][n] << "}";
+            isFirst = false;
+        }
+    }
+
+    std::cout << "]}" << std::endl;
+}
+
+/// @return Percentage of high samples.
+double Inspection::getDutyCycle(void) const {
+    return (statistics_.samples == 0U) ? 0.0
+        : (100.0 * static_cast<double>(statistics_.highSamples))
+        / statistics_.samples;
+}
+
+/**
+ * @param value String to be escaped.
+ * @return Escaped string.
+ */
+std::string Inspection::escapeJson(const std::string & value) {
+    std::ostringstream escaped;
+
+    for (const char character : value) {
+        if ((character == '"') || (character == '\\')) {
+            escaped << '\\' << character;
+        } else if (static_cast<unsigned char>(character) < 0x20U) {
+            escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                << +character;
+        } else {
+            escaped << character;
+        }
+    }
+
+    return escaped.str();
+}
@@ -24,41 +24,91 @@
 
 #include <iostream>
 
+#include "Clock.h"
 #include "InstanceLock.h"
 
 const std::string InstanceLock::LOCK_FILE = "/tmp/aircontrol.lock";
 
-void InstanceLock::lock(void) {
-    struct flock lock;
-    int fd;
+uint64_t InstanceLock::waitUs_ = 0U;
 
-    lock.l_type = F_WRLCK;
-    lock.l_whence = SEEK_SET;
-    lock.l_start = 0;
-    lock.l_len = 0;
+int InstanceLock::fd_ = -1;
 
-    // Try to create the lock file
-    fd = open(LOCK_FILE.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
-    if (fd < 0) {
-        std::cerr << "Unable to create lock file (" << LOCK_FILE << ")."
-            << std::endl;
-        exit(EXIT_FAILURE);
+bool InstanceLock::isLocked_ = false;
+
+void InstanceLock::lock(void) {
+    if (isLocked_) {
+        return;
     }
+    open();
 
     // Try to acquire the lock
-    if (fcntl(fd, F_SETLK, &lock) < 0) {
+    if (!setLock(F_WRLCK)) {
         std::cout << "Another instance of this program is running, waiting..."
             << std::endl;
 
-        while (fcntl(fd, F_SETLK, &lock) < 0) {
+        const uint64_t startUs = Clock::now();
+        while (!setLock(F_WRLCK)) {
             usleep(100*1000);
         }
+        waitUs_ = Clock::now() - startUs;
+    }
+    isLocked_ = true;
+}
+
+/// @return True if the lock has been acquired, false otherwise.
+bool InstanceLock::tryLock(void) {
+    if (!isLocked_) {
+        open();
+        isLocked_ = setLock(F_WRLCK);
+    }
+
+    return isLocked_;
+}
+
+/// @return Period waited for the lock, zero if it was acquired immediately.
+uint64_t InstanceLock::getWaitTime(void) {
+    return waitUs_;
+}
+
+/**
+ * The lock file is kept so that all program instances keep locking the same
+ * file, waiting instances would otherwise lock a removed file.
+ */
+void InstanceLock::unlock(void) {
+    if (isLocked_) {
+        setLock(F_UNLCK);
+        isLocked_ = false;
+    }
+}
+
+void InstanceLock::open(void) {
+    if (fd_ >= 0) {
+        return;
+    }
+
+    // Try to create the lock file
+    fd_ = ::open(LOCK_FILE.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    if (fd_ < 0) {
+        std::cerr << "Unable to create lock file (" << LOCK_FILE << ")."
+            << std::endl;
+        exit(EXIT_FAILURE);
     }
 
     // Ensure the lock gets released upon program termination
     atexit(unlock);
 }
 
-void InstanceLock::unlock(void) {
-    unlink(LOCK_FILE.c_str());
+/**
+ * @param type Lock type, either F_WRLCK or F_UNLCK.
+ * @return True if successful, false if another instance holds the lock.
+ */
+bool InstanceLock::setLock(const short type) {
+    struct flock lock;
+
+    lock.l_type = type;
+    lock.l_whence = SEEK_SET;
+    lock.l_start = 0;
+    lock.l_len = 0;
+
+    return fcntl(fd_, F_SETLK, &lock) == 0;
 }
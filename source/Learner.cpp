@@ -0,0 +1,500 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <set>
+
+#include "FrameIndex.h"
+#include "Learner.h"
+
+/**
+ * @param samplingRateUs Delay between two samples (unit: microseconds).
+ * @param frameGapUs Minimum silence period separating two frames (unit:
+ *                   microseconds).
+ */
+Learner::Learner(const int32_t samplingRateUs, const int32_t frameGapUs) :
+        samplingRateUs_(samplingRateUs),
+        frameGapUs_(frameGapUs),
+        runs_(),
+        learned_(),
+        frames_(0),
+        sendCommand_(0),
+        sendDelayUs_(0) {
+    // Do nothing
+}
+
+/**
+ * @param data Number of data elements the pulse consists of.
+ * @param sync Number of sync elements the pulse consists of.
+ * @param durationUs Pulse duration (unit: microseconds).
+ */
+void Learner::Fit::add(const double data, const double sync,
+        const double durationUs) {
+    dataData += data * data;
+    dataSync += data * sync;
+    syncSync += sync * sync;
+    dataDuration += data * durationUs;
+    syncDuration += sync * durationUs;
+}
+
+/**
+ * Least squares fit of the pulse durations, the element lengths are kept if
+ * they cannot be determined.
+ *
+ * @param dataLengthUs Data element length (unit: microseconds).
+ * @param syncLengthUs Sync element length (unit: microseconds).
+ */
+void Learner::Fit::solve(double & dataLengthUs, double & syncLengthUs) const {
+    const double determinant = dataData * syncSync - dataSync * dataSync;
+    const double EPSILON = std::numeric_limits<double>::epsilon();
+
+    if (syncSync == 0.0) {
+        if (dataData != 0.0) {
+            dataLengthUs = dataDuration / dataData;
+        }
+    } else if (std::fabs(determinant) > EPSILON) {
+        dataLengthUs = (dataDuration * syncSync - syncDuration * dataSync)
+            / determinant;
+        syncLengthUs = (syncDuration * dataData - dataDuration * dataSync)
+            / determinant;
+    }
+}
+
+/// @param run Next run of the air scan data.
+void Learner::add(const Types::Run & run) {
+    runs_.push_back(run);
+}
+
+/**
+ * All frames are decoded independently. The air command received most often
+ * is learned, its longest sequence of consecutive frames defines the number
+ * of repetitions and the delay between them.
+ *
+ * @return True if a target has been learned, false otherwise.
+ */
+bool Learner::learn(void) {
+    std::vector<Types::Frame> frames = FrameIndex::detect(runs_,
+        samplingRateUs_, frameGapUs_);
+    if (frames.size() > MAX_FRAMES) {
+        frames.resize(MAX_FRAMES);
+    }
+
+    // Decode all frames
+    std::vector<Decoding> decodings(frames.size());
+    std::vector<bool> isDecoded(frames.size());
+    std::map<std::string, int32_t> histogram;
+    for (auto i = 0U; i < frames.size(); i++) {
+        isDecoded[i] = findDecoding(getPulses(frames[i]), decodings[i]);
+        if (isDecoded[i]) {
+            histogram[decodings[i].airCommand]++;
+        }
+    }
+    if (histogram.empty()) {
+        return false;
+    }
+
+    const auto mostFrequent = std::max_element(histogram.begin(),
+        histogram.end(), [](const std::pair<std::string, int32_t> & a,
+        const std::pair<std::string, int32_t> & b) {
+            return a.second < b.second;
+        });
+    frames_ = mostFrequent->second;
+
+    // Find the longest sequence of frames with the learned air command
+    std::vector<double> dataLengths;
+    std::vector<double> syncLengths;
+    std::vector<double> delays;
+    sendCommand_ = 0;
+    for (auto i = 0U; i < frames.size(); i++) {
+        if (!isDecoded[i]
+            || (decodings[i].airCommand != mostFrequent->first)) {
+            continue;
+        }
+
+        dataLengths.push_back(decodings[i].dataLengthUs);
+        syncLengths.push_back(decodings[i].syncLengthUs);
+        learned_ = decodings[i];
+
+        std::vector<double> sequenceDelays;
+        auto j = i + 1U;
+        for (; (j < frames.size()) && isDecoded[j]
+                && (decodings[j].airCommand == mostFrequent->first); j++) {
+            const uint64_t gapSamples = frames[j].offset
+                - (frames[j - 1U].offset + frames[j - 1U].samples);
+            sequenceDelays.push_back(gapSamples * samplingRateUs_
+                - decodings[j].hiddenUs);
+        }
+
+        if (static_cast<int32_t>(j - i) > sendCommand_) {
+            sendCommand_ = static_cast<int32_t>(j - i);
+            delays = sequenceDelays;
+        }
+    }
+
+    // Use the medians to suppress outliers
+    const auto median = [](std::vector<double> & values) {
+        std::nth_element(values.begin(), values.begin() + values.size() / 2U,
+            values.end());
+        return values[values.size() / 2U];
+    };
+    const auto roundUs = [](const double value) {
+        const double ROUNDING_US = 10.0;
+        return std::max(0.0, std::round(value / ROUNDING_US) * ROUNDING_US);
+    };
+    learned_.dataLengthUs = roundUs(median(dataLengths));
+    learned_.syncLengthUs = roundUs(median(syncLengths));
+    sendDelayUs_ = delays.empty() ? 0
+        : static_cast<int32_t>(roundUs(median(delays)));
+
+    return true;
+}
+
+/**
+ * @param stream Stream to print to.
+ * @param name Name of the target section.
+ */
+void Learner::print(std::ostream & stream, const std::string & name) const {
+    const size_t LINE_LENGTH = 64U;
+
+    stream << std::fixed << std::setprecision(1)
+        << "// Learned from " << frames_ << " frame(s), timing error "
+        << learned_.error * 100.0 << "%" << std::endl
+        << name << ":" << std::endl
+        << "{" << std::endl
+        << "    dataLength = " << static_cast<int32_t>(learned_.dataLengthUs)
+        << ";" << std::endl
+        << "    syncLength = " << static_cast<int32_t>(learned_.syncLengthUs)
+        << ";" << std::endl
+        << "    sendCommand = " << sendCommand_ << ";" << std::endl
+        << "    sendDelay = " << sendDelayUs_ << ";" << std::endl
+        << "    airCode = " << learned_.airCode << "/*"
+        << AirCodes::getName(learned_.airCode) << "*/;" << std::endl
+        << "    airCommand =";
+
+    const std::string & airCommand = learned_.airCommand;
+    for (auto i = 0U; i < airCommand.length(); i += LINE_LENGTH) {
+        stream << std::endl << "        \""
+            << airCommand.substr(i, LINE_LENGTH) << "\"";
+    }
+    stream << ";" << std::endl
+        << "};" << std::endl;
+}
+
+/// @return Learned radio frame encoding type.
+Types::AirCode::AirCode_ Learner::getAirCode(void) const {
+    assert(frames_ != 0);
+    return learned_.airCode;
+}
+
+/// @return Learned air command.
+const std::string & Learner::getAirCommand(void) const {
+    assert(frames_ != 0);
+    return learned_.airCommand;
+}
+
+/// @return Number of frames received with the learned air command.
+int32_t Learner::getFrames(void) const {
+    return frames_;
+}
+
+/**
+ * @param frame Frame to get the pulses of.
+ * @return Pulses of the frame, followed by the silence gap as a low pulse of
+ *         infinite duration.
+ */
+std::vector<Learner::Pulse> Learner::getPulses(const Types::Frame & frame)
+        const {
+    std::vector<Pulse> pulses;
+    uint64_t position = 0U;
+
+    for (const auto & run : runs_) {
+        if (position >= frame.offset + frame.samples) {
+            break;
+        }
+
+        const uint64_t begin = std::max(position, frame.offset);
+        const uint64_t end = std::min(position + run.samples,
+            frame.offset + frame.samples);
+        if (begin < end) {
+            const double durationUs = static_cast<double>(end - begin)
+                * samplingRateUs_;
+            if (!pulses.empty() && (pulses.back().level == run.level)) {
+                pulses.back().durationUs += durationUs;
+            } else {
+                pulses.push_back({ run.level, durationUs });
+            }
+        }
+        position += run.samples;
+    }
+
+    pulses.push_back({ false, std::numeric_limits<double>::infinity() });
+
+    return pulses;
+}
+
+/**
+ * The data length candidates are derived from the shortest pulses, the sync
+ * length candidates from all pulses of the frame. Several encodings might
+ * explain the same frame with similar timing errors, in this case the one
+ * describing it with the fewest bits is used. The element lengths are fitted
+ * to the pulses of the best decoding finally.
+ *
+ * @param pulses Pulses to be decoded.
+ * @param best Place to store the best decoding to.
+ * @return True if the pulses have been decoded, false otherwise.
+ */
+bool Learner::findDecoding(const std::vector<Pulse> & pulses,
+        Decoding & best) const {
+    const double MAX_DATA_RATIO = 3.0;
+    const double MIN_SYNC_RATIO = 1.5;
+    const double ERROR_MARGIN = 0.01;
+    const uint8_t MERGED_DATA_TWELFTHS[] = { 0U, 3U, 4U, 6U, 8U, 9U, 12U };
+
+    // Distinct pulse durations
+    std::set<int64_t> durations;
+    for (auto i = 0U; i + 1U < pulses.size(); i++) {
+        durations.insert(std::llround(pulses[i].durationUs));
+    }
+
+    bool isDecoded = false;
+    uint32_t bestBits = 0U;
+    for (auto code = 0; code < Types::AirCode::MAX; code++) {
+        const auto airCode = static_cast<Types::AirCode::AirCode_>(code);
+        std::set<uint8_t> dataTwelfths;
+        std::set<uint8_t> syncTwelfths;
+        for (const auto & symbol : AirCodes::getSymbols(airCode)) {
+            for (const auto & segment : symbol) {
+                (segment.isSync ? syncTwelfths : dataTwelfths).insert(
+                    segment.twelfths);
+            }
+        }
+
+        // Data length candidates, the shortest pulses are data segments
+        std::set<int64_t> dataLengths;
+        for (const int64_t duration : durations) {
+            if (duration > *durations.begin() * MAX_DATA_RATIO) {
+                break;
+            }
+            for (const uint8_t twelfths : dataTwelfths) {
+                dataLengths.insert(std::llround(duration * 12.0 / twelfths
+                    / samplingRateUs_) * samplingRateUs_);
+            }
+        }
+
+        const uint32_t bitsPerSymbol = (AirCodes::getSymbols(airCode).size()
+            > 2U) ? 2U : 1U;
+        for (const int64_t dataLengthUs : dataLengths) {
+            // Sync segments might be merged with adjacent data segments of
+            // the same level, derive the candidates from all pulses
+            std::set<int64_t> syncLengths = { 0 };
+            for (const int64_t duration : durations) {
+                for (const uint8_t twelfths : syncTwelfths) {
+                    for (const uint8_t merged : MERGED_DATA_TWELFTHS) {
+                        const double syncLengthUs = (duration - merged / 12.0
+                            * dataLengthUs) * 12.0 / twelfths;
+
+                        // Sync elements must be distinguishable from data
+                        if (syncLengthUs >= dataLengthUs * MIN_SYNC_RATIO) {
+                            syncLengths.insert(std::llround(syncLengthUs
+                                / samplingRateUs_) * samplingRateUs_);
+                        }
+                    }
+                }
+            }
+
+            for (const int64_t syncLengthUs : syncLengths) {
+                Decoding decoding;
+                decoding.airCode = airCode;
+                decoding.dataLengthUs = static_cast<double>(dataLengthUs);
+                decoding.syncLengthUs = static_cast<double>(syncLengthUs);
+                if (!decode(pulses, decoding)) {
+                    continue;
+                }
+
+                // Prefer the lowest timing error, but the shortest
+                // description of the frame, i.e. the simplest encoding, for
+                // similar errors
+                const uint32_t bits = decoding.airCommand.length()
+                    * bitsPerSymbol;
+                if (!isDecoded || (decoding.error < best.error - ERROR_MARGIN)
+                    || ((decoding.error <= best.error + ERROR_MARGIN)
+                    && (bits < bestBits))) {
+                    best = decoding;
+                    bestBits = bits;
+                    isDecoded = true;
+                }
+            }
+        }
+    }
+
+    // Fit the element lengths to all pulses of the best decoding
+    if (isDecoded) {
+        best.fit.solve(best.dataLengthUs, best.syncLengthUs);
+    }
+
+    return isDecoded;
+}
+
+/**
+ * The pulses are matched against the symbols of the encoding, the symbols
+ * with the lowest timing error are tried first. Low segments at the
+ * beginning of the first and at the end of the last symbol are hidden in the
+ * surrounding silence gaps.
+ *
+ * @param pulses Pulses to be decoded, followed by the silence gap.
+ * @param decoding Encoding and element lengths to be used, the air command
+ *                 and the timing error will be stored to it.
+ * @return True if the pulses have been decoded, false otherwise.
+ */
+bool Learner::decode(const std::vector<Pulse> & pulses, Decoding & decoding)
+        const {
+    // Limit the backtracking on ambiguous pulses
+    const uint32_t BUDGET_PER_PULSE = 16U;
+
+    const Cursor cursor = { 0U, pulses.front().durationUs, 0.0, 0.0, 0.0, 0U,
+        0U, {} };
+    uint32_t budget = pulses.size() * BUDGET_PER_PULSE;
+    decoding.airCommand.clear();
+
+    // Pulses must not deviate by half of the shortest segment, otherwise the
+    // remainder could be another segment
+    decoding.shortestUs = std::numeric_limits<double>::max();
+    for (const auto & symbol : AirCodes::getSymbols(decoding.airCode)) {
+        for (const auto & segment : symbol) {
+            decoding.shortestUs = std::min(decoding.shortestUs,
+                segment.twelfths / 12.0 * (segment.isSync
+                ? decoding.syncLengthUs : decoding.dataLengthUs));
+        }
+    }
+
+    return decode(pulses, decoding, cursor, budget);
+}
+
+/**
+ * @param pulses Pulses to be decoded, followed by the silence gap.
+ * @param decoding Encoding and element lengths to be used, the air command
+ *                 decoded so far is extended.
+ * @param cursor Position within the pulses.
+ * @param budget Remaining number of symbol matches to be tried.
+ * @return True if the remaining pulses have been decoded, false otherwise.
+ */
+bool Learner::decode(const std::vector<Pulse> & pulses, Decoding & decoding,
+        const Cursor & cursor, uint32_t & budget) const {
+    if (cursor.pulse == pulses.size() - 1U) {
+        decoding.hiddenUs = cursor.hiddenUs;
+        decoding.error = cursor.errorUs / std::max(cursor.frameUs, 1.0);
+        decoding.fit = cursor.fit;
+        return !decoding.airCommand.empty();
+    }
+
+    std::vector<std::pair<Cursor, char>> candidates;
+    for (const auto & symbol : AirCodes::getSymbols(decoding.airCode)) {
+        if (budget == 0U) {
+            return false;
+        }
+        budget--;
+
+        Cursor next = cursor;
+        if (match(pulses, decoding, symbol, next)) {
+            candidates.emplace_back(next, symbol.character);
+        }
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(),
+        [](const std::pair<Cursor, char> & a,
+        const std::pair<Cursor, char> & b) {
+            return a.first.errorUs < b.first.errorUs;
+        });
+
+    for (const auto & candidate : candidates) {
+        decoding.airCommand += candidate.second;
+        if (decode(pulses, decoding, candidate.first, budget)) {
+            return true;
+        }
+        decoding.airCommand.pop_back();
+    }
+
+    return false;
+}
+
+/**
+ * @param pulses Pulses to be decoded, followed by the silence gap.
+ * @param decoding Encoding and element lengths to be used.
+ * @param symbol Symbol to be matched.
+ * @param cursor Position within the pulses, will be advanced behind the
+ *               symbol.
+ * @return True if the symbol matches, false otherwise.
+ */
+bool Learner::match(const std::vector<Pulse> & pulses,
+        const Decoding & decoding, const AirSymbol & symbol, Cursor & cursor)
+        const {
+    const double TOLERANCE = 0.35;
+
+    const size_t gap = pulses.size() - 1U;
+    const size_t pulse = cursor.pulse;
+    const double remainingUs = cursor.remainingUs;
+
+    for (const AirSegment & segment : symbol) {
+        const double segmentUs = segment.twelfths / 12.0
+            * (segment.isSync ? decoding.syncLengthUs : decoding.dataLengthUs);
+        cursor.frameUs += segmentUs;
+
+        if (segmentUs <= 0.0) {
+            return false;
+        } else if ((cursor.pulse == 0U) && (cursor.remainingUs
+                == pulses.front().durationUs) && !segment.level) {
+            // Leading low segments are hidden in the silence gap
+            cursor.hiddenUs += segmentUs;
+        } else if (pulses[cursor.pulse].level != segment.level) {
+            return false;
+        } else if (cursor.pulse == gap) {
+            // Trailing low segments are hidden in the silence gap
+            cursor.hiddenUs += segmentUs;
+        } else {
+            const double toleranceUs = std::max(std::min(segmentUs
+                * TOLERANCE, decoding.shortestUs / 2.0),
+                static_cast<double>(samplingRateUs_));
+            (segment.isSync ? cursor.syncTwelfths : cursor.dataTwelfths)
+                += segment.twelfths;
+
+            if (cursor.remainingUs < segmentUs - toleranceUs) {
+                return false;
+            } else if (cursor.remainingUs <= segmentUs + toleranceUs) {
+                cursor.errorUs += std::fabs(cursor.remainingUs - segmentUs);
+                cursor.fit.add(cursor.dataTwelfths / 12.0,
+                    cursor.syncTwelfths / 12.0,
+                    pulses[cursor.pulse].durationUs);
+                cursor.dataTwelfths = 0U;
+                cursor.syncTwelfths = 0U;
+                cursor.pulse++;
+                cursor.remainingUs = pulses[cursor.pulse].durationUs;
+            } else {
+                cursor.remainingUs -= segmentUs;
+            }
+        }
+    }
+
+    // Symbols hidden in the silence gap completely are ignored
+    return (cursor.pulse != pulse) || (cursor.remainingUs != remainingUs);
+}
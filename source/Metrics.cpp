@@ -0,0 +1,324 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "Metrics.h"
+
+const std::vector<double> Metrics::BUCKETS = { 0.0001, 0.00025, 0.0005, 0.001,
+    0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0 };
+
+/// @param textFile Reference of the metrics text file name.
+Metrics::Metrics(const std::string & textFile) :
+        textFile_(textFile),
+        families_(),
+        values_() {
+    // Do nothing
+}
+
+/**
+ * @param type Task type, e.g. "target".
+ * @param name Task name, e.g. the target name. Can be an empty string.
+ * @param timing Timing statistics of the task.
+ * @param startUs Program start time (unit: microseconds).
+ * @param endUs Task completion time (unit: microseconds).
+ * @param isSuccess True if the task completed successfully.
+ */
+void Metrics::addTask(const std::string & type, const std::string & name,
+        const Task::Timing & timing, const uint64_t startUs,
+        const uint64_t endUs, const bool isSuccess) {
+    const double SECONDS_PER_MICROSECOND = 1e-6;
+    const std::string labels = getLabels({ { "task", type },
+        { "name", name } });
+
+    addCounter("aircontrol_tasks_total", "Number of executed tasks.",
+        getLabels({ { "task", type }, { "name", name },
+        { "result", isSuccess ? "success" : "failure" } }), 1.0);
+    addCounter("aircontrol_edges_total", "Number of edges written or read.",
+        labels, timing.edges);
+    addCounter("aircontrol_overruns_total", "Number of edges which missed "
+        "their intended time.", labels, timing.overruns);
+    addCounter("aircontrol_backoffs_total", "Number of transmissions "
+        "deferred since the channel was busy.", labels, timing.backoffs);
+    addCounter("aircontrol_corruptions_total", "Number of transmissions "
+        "corrupted by edges missing their deadline.", labels,
+        timing.corruptions);
+    addCounter("aircontrol_retransmissions_total", "Number of transmissions "
+        "repeated since they were corrupted.", labels, timing.retransmissions);
+    addCounter("aircontrol_airtime_seconds_total", "Airtime taken from the "
+        "airtime budget.", labels, timing.airtimeUs * SECONDS_PER_MICROSECOND);
+
+    if (timing.edges != 0U) {
+        addHistogram("aircontrol_first_edge_seconds", "Time from program start "
+            "to the first edge.", labels,
+            (timing.firstEdgeUs - startUs) * SECONDS_PER_MICROSECOND);
+        addHistogram("aircontrol_burst_seconds", "Time from the first edge "
+            "to task completion.", labels,
+            (endUs - timing.firstEdgeUs) * SECONDS_PER_MICROSECOND);
+    }
+}
+
+/**
+ * @param type Task type, e.g. "target".
+ * @param waitUs Period waited for the instance lock (unit: microseconds).
+ */
+void Metrics::addLockWait(const std::string & type, const uint64_t waitUs) {
+    const double SECONDS_PER_MICROSECOND = 1e-6;
+
+    addHistogram("aircontrol_lock_wait_seconds", "Time waited for the "
+        "instance lock.", getLabels({ { "task", type } }),
+        waitUs * SECONDS_PER_MICROSECOND);
+}
+
+/**
+ * @return Status of the operation.
+ *
+ * The existing metrics are read, merged and written to a temporary file which
+ * replaces the metrics text file. A lock file next to the metrics text file
+ * prevents concurrent invocations from losing updates. Failures are reported
+ * as warnings since the metrics must not affect the outcome of the task.
+ */
+bool Metrics::write(void) const {
+    const std::string lockFile = textFile_ + ".lock";
+    const int fd = open(lockFile.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR
+        | S_IRGRP | S_IROTH);
+    if ((fd < 0) || (flock(fd, LOCK_EX) != 0)) {
+        std::cerr << "Warning: Metrics lock file '" << lockFile
+            << "' cannot be locked" << std::endl;
+        if (fd >= 0) {
+            close(fd);
+        }
+        return false;
+    }
+
+    Metrics merged(textFile_);
+    bool isSuccess = merged.read();
+    if (isSuccess) {
+        for (const auto & family : families_) {
+            for (const auto & key : family.second.series) {
+                merged.add(family.first, family.second.help,
+                    family.second.type, key, values_.at(key));
+            }
+        }
+        isSuccess = merged.save();
+    }
+
+    // Closing the file releases the lock
+    close(fd);
+
+    return isSuccess;
+}
+
+/**
+ * @param labels Label names and values.
+ * @return Label set without braces, e.g. task="target",name="outlet".
+ */
+std::string Metrics::getLabels(
+        const std::vector<std::pair<std::string, std::string>> & labels) {
+    std::string result;
+
+    for (const auto & label : labels) {
+        if (!result.empty()) {
+            result += ',';
+        }
+        result += label.first + "=\"";
+        for (const char character : label.second) {
+            switch (character) {
+                case '\\':
+                    result += "\\\\";
+                    break;
+
+                case '"':
+                    result += "\\\"";
+                    break;
+
+                case '\n':
+                    result += "\\n";
+                    break;
+
+                default:
+                    result += character;
+                    break;
+            }
+        }
+        result += '"';
+    }
+
+    return result;
+}
+
+/**
+ * @param name Metric family name.
+ * @param help Help text of the family.
+ * @param type Metric type of the family.
+ * @param key Series key, i.e. the metric name and label set.
+ * @param value Value to be added.
+ */
+void Metrics::add(const std::string & name, const std::string & help,
+        const std::string & type, const std::string & key,
+        const double value) {
+    Family & family = families_[name];
+    if (family.help.empty()) {
+        family.help = help;
+    }
+    if (family.type.empty()) {
+        family.type = type;
+    }
+
+    if (values_.find(key) == values_.end()) {
+        family.series.push_back(key);
+        values_[key] = 0.0;
+    }
+    values_[key] += value;
+}
+
+/**
+ * @param name Metric name.
+ * @param help Help text.
+ * @param labels Label set.
+ * @param value Value to be added.
+ */
+void Metrics::addCounter(const std::string & name, const std::string & help,
+        const std::string & labels, const double value) {
+    add(name, help, "counter", name + "{" + labels + "}", value);
+}
+
+/**
+ * @param name Metric name.
+ * @param help Help text.
+ * @param labels Label set.
+ * @param value Observed value.
+ */
+void Metrics::addHistogram(const std::string & name, const std::string & help,
+        const std::string & labels, const double value) {
+    for (const double bucket : BUCKETS) {
+        std::ostringstream key;
+        key << name << "_bucket{" << labels << ",le=\"" << bucket << "\"}";
+        add(name, help, "histogram", key.str(), (value <= bucket) ? 1.0 : 0.0);
+    }
+    add(name, help, "histogram", name + "_bucket{" + labels + ",le=\"+Inf\"}",
+        1.0);
+    add(name, help, "histogram", name + "_sum{" + labels + "}", value);
+    add(name, help, "histogram", name + "_count{" + labels + "}", 1.0);
+}
+
+/**
+ * @return Status of the operation, a missing metrics text file is not an
+ *         error.
+ */
+bool Metrics::read(void) {
+    std::ifstream file(textFile_);
+    if (!file.is_open()) {
+        return true;
+    }
+
+    std::map<std::string, std::pair<std::string, std::string>> declarations;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream stream(line);
+        std::string token;
+        std::string name;
+
+        if (line.compare(0U, 2U, "# ") == 0) {
+            // Help text and type declarations precede the series
+            stream >> token >> token >> name;
+            std::string text;
+            std::getline(stream >> std::ws, text);
+            if (token == "HELP") {
+                declarations[name].first = text;
+            } else if (token == "TYPE") {
+                declarations[name].second = text;
+            }
+            continue;
+        }
+
+        const size_t separator = line.rfind(' ');
+        if (line.empty() || (separator == std::string::npos)) {
+            continue;
+        }
+
+        // Histogram series are named after their family plus a suffix
+        const std::string key = line.substr(0U, separator);
+        name = key.substr(0U, key.find('{'));
+        for (const std::string suffix : { "_bucket", "_sum", "_count" }) {
+            const std::string base = name.substr(0U, name.length()
+                - std::min(name.length(), suffix.length()));
+            if ((base + suffix == name) && (declarations.find(base)
+                    != declarations.end())) {
+                name = base;
+                break;
+            }
+        }
+
+        double value;
+        try {
+            value = std::stod(line.substr(separator + 1U));
+        } catch (const std::exception &) {
+            std::cerr << "Warning: Metrics text file '" << textFile_
+                << "' is invalid" << std::endl;
+            return false;
+        }
+        add(name, declarations[name].first, declarations[name].second, key,
+            value);
+    }
+
+    return true;
+}
+
+/// @return Status of the operation.
+bool Metrics::save(void) const {
+    // The temporary file must not end with the extension watched by the
+    // textfile collector
+    const std::string temporaryFile = textFile_ + ".tmp";
+    std::ofstream file(temporaryFile, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Warning: Metrics text file '" << temporaryFile
+            << "' cannot be created" << std::endl;
+        return false;
+    }
+
+    const int PRECISION = 12;
+    file.precision(PRECISION);
+    for (const auto & family : families_) {
+        file << "# HELP " << family.first << " " << family.second.help << '\n'
+            << "# TYPE " << family.first << " " << family.second.type << '\n';
+        for (const auto & key : family.second.series) {
+            file << key << " " << values_.at(key) << '\n';
+        }
+    }
+
+    file.close();
+    if (file.fail() || (std::rename(temporaryFile.c_str(), textFile_.c_str())
+            != 0)) {
+        std::cerr << "Warning: Metrics text file '" << textFile_
+            << "' cannot be written" << std::endl;
+        std::remove(temporaryFile.c_str());
+        return false;
+    }
+
+    return true;
+}
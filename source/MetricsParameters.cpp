@@ -0,0 +1,59 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+
+#include "MetricsParameters.h"
+
+/// @param configuration Reference of the configuration.
+MetricsParameters::MetricsParameters(const Configuration & configuration) :
+        configuration_(configuration),
+        textFile_() {
+    // Do nothing
+}
+
+/// @return Status of the operation.
+bool MetricsParameters::load(void) {
+    return loadTextFile();
+}
+
+/// @return Metrics text file, an empty string if metrics are disabled.
+const std::string & MetricsParameters::getTextFile(void) const {
+    return textFile_;
+}
+
+/// @return True if successful, false otherwise.
+bool MetricsParameters::loadTextFile(void) {
+    // Metrics are disabled if the parameter is not configured
+    if (!configuration_.getValue("metrics", "textFile", textFile_)) {
+        textFile_.clear();
+        return true;
+    }
+
+    const std::string EXTENSION = ".prom";
+    if ((textFile_.length() <= EXTENSION.length())
+        || (textFile_.compare(textFile_.length() - EXTENSION.length(),
+            EXTENSION.length(), EXTENSION) != 0)) {
+        std::cerr << "Error: Configuration error (metrics): textFile must "
+            "end with '" << EXTENSION << "'" << std::endl;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,140 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <iostream>
+
+#include "DumpWriter.h"
+#include "Render.h"
+#include "ReplayParameters.h"
+#include "ScanParameters.h"
+
+/**
+ * @param configuration Reference of the configuration.
+ * @param name Target name string, must match a target configuration entry.
+ * @param dumpFile File name of the air scan dump.
+ * @param samplingRateUs Delay between two samples or
+ *                       Types::INVALID_PARAMETER to use the sampling rate of
+ *                       the air scan (unit: microseconds).
+ */
+Render::Render(Configuration & configuration, const std::string & name,
+        const std::string & dumpFile, const int32_t samplingRateUs) :
+        Task(configuration),
+        target_(std::make_unique<Target>(Target(configuration, name))),
+        dumpFile_(dumpFile),
+        samplingRateUs_(samplingRateUs) {
+    // Do nothing
+}
+
+/**
+ * @param arguments Template variables, e.g. system=FF1FF.
+ * @return True if all arguments are valid, false otherwise.
+ */
+bool Render::setArguments(const std::vector<std::string> & arguments) {
+    return target_->setArguments(arguments);
+}
+
+/// @return Program exit code.
+int Render::start(void) {
+    // GPIO pins are validated without detecting the board revision
+    Task::disableGpio();
+
+    target_->setGpioPin(gpioPin_);
+    if (!target_->prepare()) {
+        return EXIT_FAILURE;
+    }
+
+    // The dump is written like by air scans, frames are separated like for
+    // replays
+    ScanParameters scanParameters(configuration_);
+    ReplayParameters replayParameters(configuration_);
+    if (!scanParameters.load() || !replayParameters.load()) {
+        return EXIT_FAILURE;
+    }
+    const int32_t samplingRateUs = (samplingRateUs_
+        == Types::INVALID_PARAMETER) ? scanParameters.getSamplingRate()
+        : samplingRateUs_;
+
+    const std::vector<Types::Run> runs = sample(target_->getEdges(),
+        replayParameters.getFrameGap(), samplingRateUs);
+    DumpWriter writer(dumpFile_, scanParameters.getCompressDump());
+    if (!writer.open(samplingRateUs)) {
+        return EXIT_FAILURE;
+    }
+    uint64_t samples = 0U;
+    for (const auto & run : runs) {
+        if (!writer.write(run)) {
+            return EXIT_FAILURE;
+        }
+        samples += run.samples;
+    }
+    if (!writer.close()) {
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Target rendered successfully to file '" << dumpFile_
+        << "' (" << samples << " samples of " << samplingRateUs << "us)."
+        << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Sample n is taken at n times the sampling rate, i.e. pulses shorter than
+ * the sampling rate may be lost like when air scanning.
+ *
+ * @param edges Edges starting at time 0, the last one releasing the signal.
+ * @param gapUs Silence before the first and after the last edge (unit:
+ *              microseconds).
+ * @param samplingRateUs Delay between two samples (unit: microseconds).
+ * @return Runs of the sampled edges.
+ */
+std::vector<Types::Run> Render::sample(
+        const std::vector<Types::Edge> & edges, const uint64_t gapUs,
+        const int32_t samplingRateUs) {
+    std::vector<Types::Run> runs;
+    const auto getSample = [samplingRateUs](const uint64_t timeUs) {
+        return (timeUs + samplingRateUs - 1U) / samplingRateUs;
+    };
+    const auto append = [&runs, &getSample](const bool level,
+            const uint64_t beginUs, const uint64_t endUs) {
+        uint64_t samples = getSample(endUs) - getSample(beginUs);
+        while (samples > 0U) {
+            if (runs.empty() || (runs.back().level != level)
+                    || (runs.back().samples == UINT32_MAX)) {
+                runs.push_back({ level, 0U });
+            }
+            const uint32_t count = static_cast<uint32_t>(std::min<uint64_t>(
+                samples, UINT32_MAX - runs.back().samples));
+            runs.back().samples += count;
+            samples -= count;
+        }
+    };
+
+    bool level = false;
+    uint64_t timeUs = 0U;
+    for (const auto & edge : edges) {
+        append(level, timeUs, gapUs + edge.timeUs);
+        level = edge.level;
+        timeUs = gapUs + edge.timeUs;
+    }
+    append(level, timeUs, timeUs + gapUs);
+
+    return runs;
+}
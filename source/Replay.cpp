@@ -17,27 +17,36 @@
  * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
-#include <fstream>
 #include <iostream>
-#include <string.h>
-#include <unistd.h>
 
 #include <wiringPi.h>
 
+#include "Clock.h"
+#include "DumpReader.h"
+#include "FrameIndex.h"
 #include "Replay.h"
-#include "Types.h"
 
 /**
  * @param configuration Reference of the configuration.
  * @param dumpFile File name of the air Replay dump.
+ * @param frame Number of the frame to be replayed (starting at 1), 0 to
+ *              replay the whole dump.
+ * @param repeat Number of times the replay will be repeated.
+ * @param repeatGapUs Delay between repeated replays (unit: microseconds),
+ *                    Types::INVALID_PARAMETER to use the frame gap.
  */
-Replay::Replay(Configuration & configuration, const std::string & dumpFile) :
+Replay::Replay(Configuration & configuration, const std::string & dumpFile,
+        const int32_t frame, const int32_t repeat, const int32_t repeatGapUs) :
         Task(configuration),
         dumpFile_(dumpFile),
+        frame_(frame),
+        repeat_(repeat),
+        repeatGapUs_(repeatGapUs),
         parameters_(nullptr),
         samplingRateUs_(Types::INVALID_PARAMETER),
-        data_() {
+        runs_() {
     // Do nothing
 }
 
@@ -66,101 +75,126 @@ int Replay::start(void) {
         return EXIT_FAILURE;
     }
 
+    // Replay only the selected frame if requested
+    if ((frame_ != 0) && !selectFrame()) {
+        return EXIT_FAILURE;
+    }
+
+    // Repeat gaps are silent and therefore not charged
+    if (!acquireAirtime({ { gpioPin_, getDuration() * repeat_ } })
+        || !setupGpio()) {
+        return EXIT_FAILURE;
+    }
+
     airReplay();
 
     return EXIT_SUCCESS;
 }
 
+/// @return Duration of a single replay (unit: microseconds).
+uint64_t Replay::getDuration(void) const {
+    uint64_t samples = 0U;
+
+    for (const auto & run : runs_) {
+        samples += run.samples;
+    }
+
+    return samples * samplingRateUs_;
+}
+
 void Replay::airReplay(void) const {
     pinMode(gpioPin_, OUTPUT);
 
-    for (auto i = 0U; i < data_.size(); i++) {
-        digitalWrite(gpioPin_, data_.at(i) ? HIGH : LOW);
-        usleep(samplingRateUs_);
+    const int32_t repeatGapUs = (repeatGapUs_ == Types::INVALID_PARAMETER)
+        ? parameters_->getFrameGap() : repeatGapUs_;
+
+    // Write the pin only on transitions and sleep until the absolute end of
+    // each run so that sleep errors do not accumulate
+    uint64_t deadlineUs = Clock::now();
+    for (auto n = 0; n < repeat_; n++) {
+        if (n != 0) {
+            recordEdge(deadlineUs, false);
+            digitalWrite(gpioPin_, LOW);
+            deadlineUs += repeatGapUs;
+            Clock::sleepUntil(deadlineUs);
+        }
+
+        for (const auto & run : runs_) {
+            recordEdge(deadlineUs, run.level);
+            digitalWrite(gpioPin_, run.level ? HIGH : LOW);
+            deadlineUs += static_cast<uint64_t>(run.samples)
+                * samplingRateUs_;
+            Clock::sleepUntil(deadlineUs);
+        }
     }
 
     pinMode(gpioPin_, INPUT);
 }
 
-/**
- * @return Status of the operation.
- *
- * Format of the serialized file:
- * - [4 bytes] Signature
- * - [4 bytes] Sampling rate (unit: microseconds)
- * - [n bytes] Sample data, 1 byte each, 0=low / 1=high
- */
-bool Replay::deserializeData(void) {
-    std::ifstream dumpFile;
+/// @return Status of the operation.
+bool Replay::selectFrame(void) {
+    assert(frame_ > 0);
 
-    assert(dumpFile_.length() > 0U);
+    FrameIndex frameIndex(dumpFile_, samplingRateUs_,
+        parameters_->getFrameGap());
+    frameIndex.update(runs_);
 
-    // Open dump file
-    dumpFile.open(dumpFile_, std::ios::in | std::ios::binary);
-    if (!dumpFile.is_open()) {
-        std::cerr << "Error: Dump file '" << dumpFile_ << "' cannot be opened "
-            "for reading: " << strerror(errno) << std::endl;
+    const auto & frames = frameIndex.getFrames();
+    if (static_cast<size_t>(frame_) > frames.size()) {
+        std::cerr << "Error: Frame " << frame_ << " cannot be found, the "
+            "air scan dump contains " << frames.size() << " frame(s)"
+            << std::endl;
         return false;
     }
 
-    // Get the file size
-    dumpFile.seekg(0, std::ios::end);
-    const size_t dumpFileSize = dumpFile.tellg();
-    dumpFile.seekg(0, std::ios::beg);
-
-    // Read signature
-    uint32_t signature;
-    if (!dumpFile.read(reinterpret_cast<char *>(&signature),
-            sizeof(signature))) {
-        std::cerr << "Error: Unable to read signature from dump file: "
-            << strerror(errno) << std::endl;
-        return false;
-    }
+    // Cut the runs overlapping the frame to its boundaries
+    const Types::Frame & frame = frames.at(frame_ - 1);
+    std::vector<Types::Run> runs;
+    uint64_t position = 0U;
+    for (const auto & run : runs_) {
+        if (position >= frame.offset + frame.samples) {
+            break;
+        }
 
-    // Check signature
-    if (signature != Types::DUMP_SIGNATURE) {
-        std::cerr << "Error: Given file is not an air scan dump (signature "
-            "mismatch)" << std::endl;
-        return false;
+        const uint64_t begin = std::max(position, frame.offset);
+        const uint64_t end = std::min(position + run.samples,
+            frame.offset + frame.samples);
+        if (begin < end) {
+            runs.push_back({ run.level, static_cast<uint32_t>(end - begin) });
+        }
+        position += run.samples;
     }
+    runs_ = runs;
 
-    // Read sampling rate
-    if (!dumpFile.read(reinterpret_cast<char *>(&samplingRateUs_),
-            sizeof(samplingRateUs_))) {
-        std::cerr << "Error: Unable to read sampling rate from dump file: "
-            << strerror(errno) << std::endl;
-        return false;
-    }
+    return true;
+}
 
-    // Check sampling rate
-    if (samplingRateUs_ <= 0) {
-        std::cerr << "Error: Given air scan dump seems corrupted (invalid "
-            "sampling rate " << samplingRateUs_ << ")" << std::endl;
+/**
+ * @return Status of the operation.
+ *
+ * See DumpReader::open() for the format of the serialized file.
+ */
+bool Replay::deserializeData(void) {
+    DumpReader reader(dumpFile_);
+
+    if (!reader.open()) {
         return false;
     }
+    samplingRateUs_ = reader.getSamplingRate();
 
-    // Read sample data
-    char data;
-    while (dumpFile.read(&data, sizeof(data))) {
-        if ((data < 0) || (data > 1)) {
-            std::cerr << "Error: Given air scan dump seems corrupted (invalid "
-                "data value " << +data << ")" << std::endl;
-            return false;
-        }
-        data_.push_back(data == 1);
+    // Decompress the sample data block-wise into runs
+    Types::Run run;
+    while (reader.read(run)) {
+        runs_.push_back(run);
     }
 
     // Check sample data
-    const size_t expectedDataSize = dumpFileSize - sizeof(signature)
-        - sizeof(samplingRateUs_);
-    if (data_.size() == 0U) {
+    if (reader.hasFailed()) {
+        return false;
+    } else if (runs_.size() == 0U) {
         std::cerr << "Error: Given air scan dump seems corrupted (no data "
             "elements found)" << std::endl;
         return false;
-    } else if (data_.size() != expectedDataSize) {
-        std::cerr << "Error: Given air scan dump seems corrupted (invalid "
-            "number of data elements read)" << std::endl;
-        return false;
     }
 
     return true;
@@ -27,13 +27,15 @@
 /// @param configuration Configuration data.
 ReplayParameters::ReplayParameters(const Configuration & configuration) :
         configuration_(configuration),
-        gpioPin_(Types::INVALID_GPIO_PIN) {
+        gpioPin_(Types::INVALID_GPIO_PIN),
+        frameGapUs_(Types::INVALID_PARAMETER) {
     // Do nothing
 }
 
 /// @return Status of the operation.
 bool ReplayParameters::load(void) {
-    return loadGpioPin();
+    return loadGpioPin()
+        && loadFrameGap();
 }
 
 /// @return GPIO pin.
@@ -42,6 +44,12 @@ uint8_t ReplayParameters::getGpioPin(void) const {
     return gpioPin_;
 }
 
+/// @return Minimum silence period separating two frames.
+int32_t ReplayParameters::getFrameGap(void) const {
+    assert(frameGapUs_ != Types::INVALID_PARAMETER);
+    return frameGapUs_;
+}
+
 /// @return True if successful, false otherwise.
 bool ReplayParameters::loadGpioPin(void) {
     int32_t value;
@@ -62,3 +70,19 @@ bool ReplayParameters::loadGpioPin(void) {
 
     return true;
 }
+
+/// @return True if successful, false otherwise.
+bool ReplayParameters::loadFrameGap(void) {
+    if (!configuration_.getValue("replay", "frameGap", frameGapUs_)) {
+        frameGapUs_ = DEFAULT_FRAME_GAP_US;
+        return true;
+    }
+
+    if (frameGapUs_ <= 0) {
+        std::cerr << "Error: Configuration error (replay): frameGap is "
+            "invalid" << std::endl;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,477 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <climits>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+
+#include "Clock.h"
+#include "InstanceLock.h"
+#include "RequestRing.h"
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+    "Futex words must be plain 32-bit integers");
+static_assert(ATOMIC_INT_LOCK_FREE == 2,
+    "Atomics in shared memory must be lock-free");
+
+const std::string RequestRing::RUNTIME_DIRECTORY = "/run";
+
+const std::string RequestRing::USER_RUNTIME_DIRECTORY = "/run/user/";
+
+const std::string RequestRing::RING_FILE = "aircontrol.ring";
+
+/**
+ * @param configuration Absolute configuration file location of this program
+ *                      instance, requests of other configurations are
+ *                      rejected.
+ * @param executor Function executing a request.
+ */
+RequestRing::RequestRing(const std::string & configuration,
+        const Executor & executor) :
+        configuration_(configuration),
+        executor_(executor),
+        fd_(-1),
+        ring_(nullptr) {
+    // Do nothing
+}
+
+RequestRing::~RequestRing(void) {
+    if (ring_ != nullptr) {
+        munmap(ring_, sizeof(Ring));
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+/**
+ * @return True if successful, false otherwise.
+ *
+ * The ring file is only used if it is a regular file owned by this user with
+ * mode 0600, symbolic links are not followed. The file is extended with
+ * zeros by the first program instance, which is a valid empty ring.
+ */
+bool RequestRing::open(void) {
+    std::string ringFile;
+    if (!getRingFile(ringFile)) {
+        return false;
+    }
+
+    fd_ = ::open(ringFile.c_str(), O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW
+        | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd_ >= 0) {
+        // The mode must not depend on the umask
+        fchmod(fd_, S_IRUSR | S_IWUSR);
+    } else if (errno == EEXIST) {
+        fd_ = ::open(ringFile.c_str(), O_RDWR | O_NOFOLLOW | O_CLOEXEC);
+    }
+
+    struct stat status;
+    if ((fd_ < 0) || (fstat(fd_, &status) != 0)) {
+        std::cerr << "Warning: Request ring file '" << ringFile
+            << "' cannot be opened" << std::endl;
+        return false;
+    } else if (!S_ISREG(status.st_mode) || (status.st_uid != geteuid())
+        || ((status.st_mode & ALLPERMS) != (S_IRUSR | S_IWUSR))) {
+        std::cerr << "Warning: Request ring file '" << ringFile
+            << "' is not a regular file owned by this user with mode 0600"
+            << std::endl;
+        return false;
+    }
+
+    lockRing();
+    const bool isExtended = (static_cast<size_t>(status.st_size)
+        >= sizeof(Ring)) || (ftruncate(fd_, sizeof(Ring)) == 0);
+    unlockRing();
+    void * memory = isExtended ? mmap(nullptr, sizeof(Ring), PROT_READ
+        | PROT_WRITE, MAP_SHARED, fd_, 0) : MAP_FAILED;
+    if (memory == MAP_FAILED) {
+        std::cerr << "Warning: Request ring file '" << ringFile
+            << "' cannot be mapped" << std::endl;
+        return false;
+    }
+    ring_ = static_cast<Ring *>(memory);
+
+    lockRing();
+    if (ring_->magic == 0U) {
+        ring_->magic = MAGIC;
+    }
+    const bool isCompatible = ring_->magic == MAGIC;
+    unlockRing();
+    if (!isCompatible) {
+        std::cerr << "Warning: Request ring file '" << ringFile
+            << "' has an incompatible layout" << std::endl;
+        munmap(ring_, sizeof(Ring));
+        ring_ = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @param request Request to be executed.
+ * @param exitCode Place to store the program exit code of the request to.
+ * @return True if the request has been executed, false if it has to be
+ *         executed by this instance itself.
+ *
+ * The request is not executed if the ring is full, the request is too large,
+ * the leader uses another configuration file, the leader terminated while
+ * executing it or the leader did not start to execute it within
+ * WAIT_LIMIT_MS.
+ */
+bool RequestRing::submit(const Request & request, int & exitCode) {
+    uint32_t ticket;
+
+    return enqueue(serialize(request), request.startUs, ticket)
+        && wait(ticket, exitCode);
+}
+
+/**
+ * The instance lock must be held. It is released once all requests have
+ * been executed, requests enqueued meanwhile are executed while the lock
+ * can be acquired again.
+ */
+void RequestRing::lead(void) {
+    do {
+        drain();
+        InstanceLock::unlock();
+    } while (isPending() && InstanceLock::tryLock());
+}
+
+/**
+ * @param ringFile Place to store the location of the ring file to.
+ * @return True if a trusted runtime directory exists, false otherwise.
+ *
+ * Instances running as root use the root-owned runtime directory, other
+ * users their own runtime directory. Directories writable by other users are
+ * not trusted, the ring is disabled then.
+ */
+bool RequestRing::getRingFile(std::string & ringFile) {
+    const uid_t user = geteuid();
+    const std::string directory = (user == 0) ? RUNTIME_DIRECTORY
+        : USER_RUNTIME_DIRECTORY + std::to_string(user);
+    struct stat status;
+
+    if ((lstat(directory.c_str(), &status) != 0) || !S_ISDIR(status.st_mode)
+        || ((status.st_uid != 0) && (status.st_uid != user))
+        || ((status.st_mode & (S_IWGRP | S_IWOTH)) != 0U)) {
+        return false;
+    }
+    ringFile = directory + "/" + RING_FILE;
+
+    return true;
+}
+
+void RequestRing::lockRing(void) const {
+    while ((flock(fd_, LOCK_EX) != 0) && (errno == EINTR));
+}
+
+void RequestRing::unlockRing(void) const {
+    flock(fd_, LOCK_UN);
+}
+
+/**
+ * @param data Serialized request.
+ * @param startUs Start time of the requesting program instance.
+ * @param ticket Place to store the ticket of the request to.
+ * @return True if successful, false if the ring is full or the request is
+ *         too large.
+ *
+ * The request is published by advancing the head last, i.e. a partially
+ * written slot of a terminated instance is overwritten by the next one.
+ */
+bool RequestRing::enqueue(const std::string & data, const uint64_t startUs,
+        uint32_t & ticket) {
+    if (data.size() > REQUEST_SIZE) {
+        return false;
+    }
+
+    lockRing();
+    ticket = ring_->head;
+    Slot & slot = ring_->slots[ticket % SLOTS];
+    const bool isFree = slot.state == State::FREE;
+    if (isFree) {
+        slot.ticket = ticket;
+        slot.startUs = startUs;
+        slot.size = static_cast<uint32_t>(data.size());
+        data.copy(slot.data, data.size());
+        slot.state = State::QUEUED;
+        ring_->head = ticket + 1U;
+    }
+    unlockRing();
+
+    return isFree;
+}
+
+/**
+ * @param pendings Requests to append the dequeued requests to.
+ *
+ * The ring must be locked. The requests remain in their slots, marked as
+ * executed by this instance, until they have been completed so that they can
+ * be recovered if this instance terminates meanwhile.
+ */
+void RequestRing::dequeue(std::vector<Pending> & pendings) {
+    for (; ring_->tail != ring_->head; ring_->tail++) {
+        Slot & slot = ring_->slots[ring_->tail % SLOTS];
+        if (slot.state == State::QUEUED) {
+            slot.state = State::ACTIVE;
+            slot.leader = getpid();
+            pendings.push_back({ slot.ticket, slot.startUs,
+                std::string(slot.data, slot.size) });
+        } else if (slot.state == State::CANCELLED) {
+            slot.state = State::FREE;
+        }
+    }
+}
+
+/**
+ * The ring must be locked. Requests of a terminated leader might have been
+ * transmitted partially, they are rejected instead of being executed again
+ * so that the waiting instances transmit them themselves.
+ */
+void RequestRing::recover(void) {
+    for (auto & slot : ring_->slots) {
+        if ((slot.state == State::ACTIVE) && (slot.leader != getpid())
+            && (kill(slot.leader, 0) != 0) && (errno == ESRCH)) {
+            std::cerr << "Warning: Request " << slot.ticket << " of "
+                "terminated instance " << slot.leader << " is rejected"
+                << std::endl;
+            complete(slot, Result::REJECTED);
+        }
+    }
+}
+
+/**
+ * @param ticket Ticket of the request.
+ * @return True if the request has been withdrawn, false if it is being
+ *         executed or has been completed.
+ */
+bool RequestRing::withdraw(const uint32_t ticket) {
+    lockRing();
+    Slot & slot = ring_->slots[ticket % SLOTS];
+    const bool isQueued = (slot.state == State::QUEUED)
+        && (slot.ticket == ticket);
+    if (isQueued) {
+        slot.state = State::CANCELLED;
+    }
+    unlockRing();
+
+    return isQueued;
+}
+
+/// @return True if a request is ready to be dequeued, false otherwise.
+bool RequestRing::isPending(void) const {
+    lockRing();
+    const bool isPending = ring_->tail != ring_->head;
+    unlockRing();
+
+    return isPending;
+}
+
+/**
+ * Requests are executed in the order they have been enqueued. Before each
+ * execution all requests enqueued meanwhile are dequeued, identical ones are
+ * completed by the same execution. Requests enqueued during an execution are
+ * executed again since their transmission must not start before the request.
+ * Requests of other configuration files are rejected, the configuration file
+ * is never taken from the ring.
+ */
+void RequestRing::drain(void) {
+    std::vector<Pending> pendings;
+
+    for (;;) {
+        lockRing();
+        recover();
+        dequeue(pendings);
+        unlockRing();
+        if (pendings.empty()) {
+            return;
+        }
+
+        const std::string data = pendings.front().data;
+        Request request;
+        Result::Result_ result = Result::FAILURE;
+        if (!deserialize(data, request)) {
+            std::cerr << "Error: Request " << pendings.front().ticket
+                << " is invalid" << std::endl;
+        } else if (request.configuration != configuration_) {
+            result = Result::REJECTED;
+        } else {
+            request.startUs = pendings.front().startUs;
+            result = (executor_(request) == EXIT_SUCCESS) ? Result::SUCCESS
+                : Result::FAILURE;
+        }
+
+        for (auto it = pendings.begin(); it != pendings.end();) {
+            if (it->data == data) {
+                complete(it->ticket, result);
+                it = pendings.erase(it);
+            } else {
+                it++;
+            }
+        }
+    }
+}
+
+/**
+ * @param ticket Ticket of the request.
+ * @param result Result of the request.
+ */
+void RequestRing::complete(const uint32_t ticket,
+        const Result::Result_ result) {
+    lockRing();
+    Slot & slot = ring_->slots[ticket % SLOTS];
+    if ((slot.state == State::ACTIVE) && (slot.ticket == ticket)
+        && (slot.leader == getpid())) {
+        complete(slot, result);
+    }
+    unlockRing();
+}
+
+/**
+ * @param slot Slot of the request, the ring must be locked.
+ * @param result Result of the request.
+ */
+void RequestRing::complete(Slot & slot, const Result::Result_ result) {
+    slot.completion.store(((slot.ticket + 1U) << 2) | result,
+        std::memory_order_release);
+    slot.state = State::FREE;
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&slot.completion),
+        FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+/**
+ * @param ticket Ticket of the request.
+ * @param exitCode Place to store the program exit code of the request to.
+ * @return True if the request has been executed, false if it has been
+ *         rejected or withdrawn.
+ *
+ * The futex is woken by the leader, the timeout detects a terminated leader,
+ * whose requests are rejected by the instance taking over. A request not
+ * executed within WAIT_LIMIT_MS is withdrawn. Requests being executed are
+ * waited for since withdrawing them would transmit them twice. Completions
+ * are compared by their age so that a completion of a later request reusing
+ * the slot is not mistaken for a pending one.
+ */
+bool RequestRing::wait(const uint32_t ticket, int & exitCode) {
+    const uint32_t AGE_MASK = UINT32_MAX >> 2;
+    const uint32_t RESULT_MASK = 3U;
+    const uint32_t expected = (ticket + 1U) & AGE_MASK;
+    const uint64_t limitUs = Clock::now() + WAIT_LIMIT_MS * 1000ULL;
+    std::atomic<uint32_t> & completion = ring_->slots[ticket % SLOTS]
+        .completion;
+
+    for (;;) {
+        const uint32_t value = completion.load(std::memory_order_acquire);
+        const uint32_t age = ((value >> 2) - expected) & AGE_MASK;
+        if (age == 0U) {
+            exitCode = ((value & RESULT_MASK) == Result::SUCCESS)
+                ? EXIT_SUCCESS : EXIT_FAILURE;
+            return (value & RESULT_MASK) != Result::REJECTED;
+        } else if (age < (AGE_MASK >> 1)) {
+            std::cerr << "Error: Result of request " << ticket
+                << " has been overwritten" << std::endl;
+            exitCode = EXIT_FAILURE;
+            return true;
+        }
+
+        if (InstanceLock::tryLock()) {
+            lead();
+            continue;
+        } else if ((Clock::now() >= limitUs) && withdraw(ticket)) {
+            std::cerr << "Warning: Request " << ticket << " has not been "
+                "executed within " << WAIT_LIMIT_MS << "ms" << std::endl;
+            return false;
+        }
+
+        struct timespec timeout;
+        timeout.tv_sec = WAIT_TIMEOUT_MS / 1000U;
+        timeout.tv_nsec = (WAIT_TIMEOUT_MS % 1000U) * 1000000L;
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&completion),
+            FUTEX_WAIT, value, &timeout, nullptr, 0);
+    }
+}
+
+/**
+ * @param request Request to be serialized.
+ * @return Fields of the request, each terminated by a zero character.
+ */
+std::string RequestRing::serialize(const Request & request) {
+    std::string data;
+
+    data.append(request.configuration).push_back('\0');
+    data.append(std::to_string(request.gpioPin)).push_back('\0');
+    data.append(std::to_string(request.targets.size())).push_back('\0');
+    for (const auto & target : request.targets) {
+        data.append(target).push_back('\0');
+    }
+    for (const auto & argument : request.arguments) {
+        data.append(argument).push_back('\0');
+    }
+
+    return data;
+}
+
+/**
+ * @param data Serialized request.
+ * @param request Place to store the request to.
+ * @return True if successful, false if the request is malformed.
+ */
+bool RequestRing::deserialize(const std::string & data, Request & request) {
+    std::vector<std::string> fields;
+
+    for (size_t begin = 0U; begin < data.size();) {
+        const size_t end = data.find('\0', begin);
+        if (end == std::string::npos) {
+            return false;
+        }
+        fields.push_back(data.substr(begin, end - begin));
+        begin = end + 1U;
+    }
+
+    const size_t FIXED_FIELDS = 3U;
+    if (fields.size() < FIXED_FIELDS) {
+        return false;
+    }
+    const size_t targets = std::strtoul(fields[2].c_str(), nullptr, 10);
+    if ((targets == 0U) || (fields.size() < FIXED_FIELDS + targets)) {
+        return false;
+    }
+
+    request.configuration = fields[0];
+    request.gpioPin = static_cast<uint8_t>(std::atoi(fields[1].c_str()));
+    request.targets.assign(fields.begin() + FIXED_FIELDS,
+        fields.begin() + FIXED_FIELDS + targets);
+    request.arguments.assign(fields.begin() + FIXED_FIELDS + targets,
+        fields.end());
+
+    return true;
+}
@@ -0,0 +1,354 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include "RunDetector.h"
+
+/// Number of samples compared at once by the kernels.
+static const size_t BLOCK_SIZE = 64U;
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * @param samples Samples to be searched, one byte per sample.
+ * @param size Number of samples.
+ * @param level Signal level of the current run.
+ * @return Number of samples within whole blocks preceding the first block
+ *         containing a transition.
+ *
+ * Compiled for AVX2 regardless of the compiler flags, it is only selected if
+ * the CPU supports AVX2.
+ */
+__attribute__((target("avx2")))
+static size_t findBlockAvx2(const uint8_t * samples, const size_t size,
+        const uint8_t level) {
+    const __m256i pattern = _mm256_set1_epi8(static_cast<char>(level));
+    size_t i = 0U;
+
+    for (; i + BLOCK_SIZE <= size; i += BLOCK_SIZE) {
+        const __m256i a = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(&samples[i]));
+        const __m256i b = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(&samples[i + 32U]));
+        const __m256i diff = _mm256_or_si256(_mm256_xor_si256(a, pattern),
+            _mm256_xor_si256(b, pattern));
+        if (!_mm256_testz_si256(diff, diff)) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/// @return True if the CPU supports AVX2, false otherwise.
+static bool isAvx2Supported(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+/**
+ * @param samples Samples to be searched, one byte per sample.
+ * @param size Number of samples.
+ * @param level Signal level of the current run.
+ * @return Number of samples within whole blocks preceding the first block
+ *         containing a transition.
+ */
+__attribute__((target("sse2")))
+static size_t findBlockSse2(const uint8_t * samples, const size_t size,
+        const uint8_t level) {
+    const __m128i pattern = _mm_set1_epi8(static_cast<char>(level));
+    size_t i = 0U;
+
+    for (; i + BLOCK_SIZE <= size; i += BLOCK_SIZE) {
+        const __m128i * block = reinterpret_cast<const __m128i *>(&samples[i]);
+        const __m128i diff = _mm_or_si128(
+            _mm_or_si128(_mm_xor_si128(_mm_loadu_si128(&block[0]), pattern),
+            _mm_xor_si128(_mm_loadu_si128(&block[1]), pattern)),
+            _mm_or_si128(_mm_xor_si128(_mm_loadu_si128(&block[2]), pattern),
+            _mm_xor_si128(_mm_loadu_si128(&block[3]), pattern)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128()))
+                != 0xFFFF) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/// @return True if the CPU supports SSE2, false otherwise.
+static bool isSse2Supported(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+/**
+ * @param samples Samples to be searched, one byte per sample.
+ * @param size Number of samples.
+ * @param level Signal level of the current run.
+ * @return Number of samples within whole blocks preceding the first block
+ *         containing a transition.
+ *
+ * Only compiled if NEON is enabled by the compiler flags, see Makefile.
+ */
+static size_t findBlockNeon(const uint8_t * samples, const size_t size,
+        const uint8_t level) {
+    const uint8x16_t pattern = vdupq_n_u8(level);
+    size_t i = 0U;
+
+    for (; i + BLOCK_SIZE <= size; i += BLOCK_SIZE) {
+        const uint8x16_t diff = vorrq_u8(
+            vorrq_u8(veorq_u8(vld1q_u8(&samples[i]), pattern),
+            veorq_u8(vld1q_u8(&samples[i + 16U]), pattern)),
+            vorrq_u8(veorq_u8(vld1q_u8(&samples[i + 32U]), pattern),
+            veorq_u8(vld1q_u8(&samples[i + 48U]), pattern)));
+        const uint8x8_t folded = vorr_u8(vget_low_u8(diff),
+            vget_high_u8(diff));
+        if (vget_lane_u64(vreinterpret_u64_u8(folded), 0) != 0U) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/// @return True since the NEON kernel is only compiled if enabled.
+static bool isNeonSupported(void) {
+    return true;
+}
+#endif
+
+/**
+ * @param samples Samples to be searched, one byte per sample.
+ * @param size Number of samples.
+ * @param level Signal level of the current run.
+ * @return Number of samples within whole blocks preceding the first block
+ *         containing a transition.
+ */
+static size_t findBlockWords(const uint8_t * samples, const size_t size,
+        const uint8_t level) {
+    const uint64_t pattern = level * 0x0101010101010101ULL;
+    size_t i = 0U;
+
+    for (; i + BLOCK_SIZE <= size; i += BLOCK_SIZE) {
+        uint64_t words[BLOCK_SIZE / sizeof(uint64_t)];
+        memcpy(words, &samples[i], sizeof(words));
+        uint64_t diff = 0U;
+        for (const auto word : words) {
+            diff |= word ^ pattern;
+        }
+        if (diff != 0U) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/// @return True since 64 bit words are supported by all CPUs.
+static bool isWordsSupported(void) {
+    return true;
+}
+
+const RunDetector::Kernel RunDetector::KERNELS[] = {
+#if defined(__x86_64__) || defined(__i386__)
+    { "AVX2", isAvx2Supported, findBlockAvx2 },
+    { "SSE2", isSse2Supported, findBlockSse2 },
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    { "NEON", isNeonSupported, findBlockNeon },
+#endif
+    { "64 bit words", isWordsSupported, findBlockWords }
+};
+
+const RunDetector::Kernel * RunDetector::kernel_ =
+    RunDetector::getFastestKernel();
+
+/**
+ * Blocks of 64 samples are compared at once by the selected kernel, the
+ * block containing the transition is searched sample by sample.
+ *
+ * @param samples Samples to be searched, one byte per sample.
+ * @param size Number of samples.
+ * @param level Signal level of the current run.
+ * @return Number of samples until the first sample differing from the given
+ *         level, the number of samples if there is none.
+ */
+size_t RunDetector::findTransition(const uint8_t * samples, const size_t size,
+        const uint8_t level) {
+    const size_t i = kernel_->find(samples, size, level);
+
+    return i + findTransitionScalar(&samples[i], size - i, level);
+}
+
+/**
+ * @param samples Samples to be searched, one byte per sample.
+ * @param size Number of samples.
+ * @param level Signal level of the current run.
+ * @return Number of samples until the first sample differing from the given
+ *         level, the number of samples if there is none.
+ */
+size_t RunDetector::findTransitionScalar(const uint8_t * samples,
+        const size_t size, const uint8_t level) {
+    size_t i = 0U;
+
+    for (; (i < size) && (samples[i] == level); i++);
+
+    return i;
+}
+
+/**
+ * The first run is merged with the last run of the given runs if both share
+ * the same level, i.e. samples can be converted block by block.
+ *
+ * @param samples Samples to be converted, one byte per sample.
+ * @param size Number of samples.
+ * @param runs Runs to append the runs of the samples to.
+ */
+void RunDetector::detect(const uint8_t * samples, const size_t size,
+        std::vector<Types::Run> & runs) {
+    for (size_t i = 0U; i < size;) {
+        const size_t count = findTransition(&samples[i], size - i,
+            samples[i]);
+        append(samples[i] != 0U, count, runs);
+        i += count;
+    }
+}
+
+/**
+ * @param samples Samples to be converted, one byte per sample.
+ * @param size Number of samples.
+ * @param runs Runs to append the runs of the samples to.
+ */
+void RunDetector::detectScalar(const uint8_t * samples, const size_t size,
+        std::vector<Types::Run> & runs) {
+    for (size_t i = 0U; i < size;) {
+        const size_t count = findTransitionScalar(&samples[i], size - i,
+            samples[i]);
+        append(samples[i] != 0U, count, runs);
+        i += count;
+    }
+}
+
+/**
+ * @param words Samples to be converted, 64 samples per word starting with the
+ *              least significant bit.
+ * @param size Number of samples.
+ * @param runs Runs to append the runs of the samples to.
+ */
+void RunDetector::detectPacked(const uint64_t * words, const size_t size,
+        std::vector<Types::Run> & runs) {
+    const size_t WORD_BITS = 64U;
+
+    for (size_t i = 0U; i < size;) {
+        const bool level = ((words[i / WORD_BITS] >> (i % WORD_BITS)) & 1U)
+            != 0U;
+        const uint64_t pattern = level ? UINT64_MAX : 0U;
+
+        // Search the remainder of the current word, then whole words
+        size_t end = i;
+        uint64_t diff = (words[end / WORD_BITS] ^ pattern) >> (end % WORD_BITS);
+        if (diff == 0U) {
+            end += WORD_BITS - (end % WORD_BITS);
+            while ((end < size)
+                    && ((diff = words[end / WORD_BITS] ^ pattern) == 0U)) {
+                end += WORD_BITS;
+            }
+        }
+        if (end < size) {
+            end += __builtin_ctzll(diff);
+        }
+        end = std::min(end, size);
+
+        append(level, end - i, runs);
+        i = end;
+    }
+}
+
+/// @return Names of the kernels.
+std::vector<std::string> RunDetector::getKernels(void) {
+    std::vector<std::string> names;
+
+    for (const auto & kernel : KERNELS) {
+        if (kernel.isSupported()) {
+            names.push_back(kernel.name);
+        }
+    }
+
+    return names;
+}
+
+/**
+ * @param name Name of the kernel, see getKernels().
+ * @return True if the kernel is supported, false otherwise.
+ *
+ * Not thread-safe, meant to compare the kernels before samples are processed
+ * concurrently.
+ */
+bool RunDetector::setKernel(const std::string & name) {
+    for (const auto & kernel : KERNELS) {
+        if ((name == kernel.name) && kernel.isSupported()) {
+            kernel_ = &kernel;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/// @return Name of the instruction set.
+const char * RunDetector::getInstructionSet(void) {
+    return kernel_->name;
+}
+
+/// @return Fastest kernel supported by the CPU.
+const RunDetector::Kernel * RunDetector::getFastestKernel(void) {
+    for (const auto & kernel : KERNELS) {
+        if (kernel.isSupported()) {
+            return &kernel;
+        }
+    }
+
+    // The last kernel is supported by all CPUs
+    return &KERNELS[sizeof(KERNELS) / sizeof(KERNELS[0]) - 1U];
+}
+
+/**
+ * @param level Signal level of the samples.
+ * @param samples Number of samples.
+ * @param runs Runs to append the samples to.
+ */
+void RunDetector::append(const bool level, size_t samples,
+        std::vector<Types::Run> & runs) {
+    while (samples > 0U) {
+        if (runs.empty() || (runs.back().level != level)
+                || (runs.back().samples == UINT32_MAX)) {
+            runs.push_back({ level, 0U });
+        }
+        const uint32_t count = static_cast<uint32_t>(std::min<size_t>(
+            samples, UINT32_MAX - runs.back().samples));
+        runs.back().samples += count;
+        samples -= count;
+    }
+}
@@ -18,26 +18,37 @@
  */
 
 #include <cassert>
-#include <fstream>
 #include <iostream>
-#include <string.h>
 #include <unistd.h>
 
 #include <wiringPi.h>
 
+#include "Clock.h"
+#include "DumpWriter.h"
+#include "FrameDeduplicator.h"
+#include "Learner.h"
+#include "ReplayParameters.h"
+#include "RunDetector.h"
 #include "Scan.h"
+#include "TargetIndex.h"
 
 /**
  * @param configuration Reference of the configuration.
  * @param durationMs Air scan duration (unit: milliseconds).
  * @param dumpFile Reference of the dump file. Can be an empty string to dump
  *                 human readable ASCII output to stdout.
+ * @param outputFormat Output format of the scan results, a learned target
+ *                     section or the unique frames, optionally identified
+ *                     by the configured targets, are printed in addition to
+ *                     the dump file.
  */
 Scan::Scan(Configuration & configuration, const int32_t durationMs,
-        const std::string & dumpFile) :
+        const std::string & dumpFile,
+        const Types::OutputFormat::OutputFormat_ outputFormat) :
         Task(configuration),
         durationMs_(durationMs),
         dumpFile_(dumpFile),
+        outputFormat_(outputFormat),
         parameters_(nullptr),
         data_() {
     // Do nothing
@@ -63,13 +74,23 @@ int Scan::start(void) {
         return EXIT_FAILURE;
     }
 
+    if (!setupGpio()) {
+        return EXIT_FAILURE;
+    }
+
     // Perform the air scan and process the results
     airScan();
-    if (dumpFile_.length() == 0U) {
-        printData();
-    } else {
+    if (dumpFile_.length() != 0U) {
         serializeData();
     }
+    if (outputFormat_ == Types::OutputFormat::TARGET) {
+        return learnTarget() ? EXIT_SUCCESS : EXIT_FAILURE;
+    } else if ((outputFormat_ == Types::OutputFormat::FRAMES)
+            || (outputFormat_ == Types::OutputFormat::IDENTIFY)) {
+        return printFrames() ? EXIT_SUCCESS : EXIT_FAILURE;
+    } else if (dumpFile_.length() == 0U) {
+        printData();
+    }
 
     return EXIT_SUCCESS;
 }
@@ -81,82 +102,118 @@ void Scan::airScan(void) {
 
     pinMode(gpioPin_, INPUT);
 
-    // Collect the data
+    // Collect the data, level changes are traced as edges at the time they
+    // were sampled
+    const uint64_t startUs = Clock::now();
     data_.clear();
+    data_.reserve(SAMPLES);
     while (data_.size() < static_cast<size_t>(SAMPLES)) {
-        data_.push_back(digitalRead(gpioPin_) > 0);
+        data_.push_back((digitalRead(gpioPin_) > 0) ? 1U : 0U);
+        if ((data_.size() == 1U)
+                || (data_.back() != data_[data_.size() - 2U])) {
+            recordEdge(startUs + (data_.size() - 1U)
+                * parameters_->getSamplingRate(), data_.back() != 0U);
+        }
         usleep(parameters_->getSamplingRate());
     }
 }
 
+/// @return Runs of equal samples, in chronological order.
+std::vector<Types::Run> Scan::getRuns(void) const {
+    std::vector<Types::Run> runs;
+
+    RunDetector::detect(data_.data(), data_.size(), runs);
+
+    return runs;
+}
+
 void Scan::printData(void) const {
     bool previousData = false;
 
-    for (auto i = 0U; i < data_.size(); i++) {
-        if (data_.at(i)) {
-            if (!previousData) {
-                std::cout << "+----+" << std::endl;
-            }
-            std::cout << "     |" << std::endl;
-        } else {
-            if (previousData) {
-                std::cout << "+----+" << std::endl;
-            }
-            std::cout << "|" << std::endl;
+    for (const auto & run : getRuns()) {
+        if (run.level != previousData) {
+            std::cout << "+----+" << std::endl;
+        }
+        for (auto i = 0U; i < run.samples; i++) {
+            std::cout << (run.level ? "     |" : "|") << std::endl;
         }
 
-        previousData = data_.at(i);
+        previousData = run.level;
     }
 }
 
-/**
- * Format of the serialized file:
- * - [4 bytes] Signature
- * - [4 bytes] Sampling rate (unit: microseconds)
- * - [n bytes] Sample data, 1 byte each, 0=low / 1=high
- */
+/// See DumpReader::open() for the format of the serialized file.
 void Scan::serializeData(void) const {
-    std::ofstream dumpFile;
-
-    assert(dumpFile_.length() > 0U);
+    DumpWriter writer(dumpFile_, parameters_->getCompressDump());
 
-    // Open dump file
-    dumpFile.open(dumpFile_, std::ios::out | std::ios::binary
-        | std::ios::trunc);
-    if (!dumpFile.is_open()) {
-        std::cerr << "Error: Dump file '" << dumpFile_ << "' cannot be opened "
-            "for writing: " << strerror(errno) << std::endl;
+    if (!writer.open(parameters_->getSamplingRate())) {
         return;
     }
 
-    // Write signature
-    if (!dumpFile.write(reinterpret_cast<const char *>(&Types::DUMP_SIGNATURE),
-            sizeof(Types::DUMP_SIGNATURE))) {
-        std::cerr << "Error: Unable to write signature to dump file: "
-            << strerror(errno) << std::endl;
+    // Write sample data, compressed on the fly if configured
+    for (const auto & run : getRuns()) {
+        if (!writer.write(run)) {
+            return;
+        }
+    }
+    if (!writer.close()) {
         return;
     }
 
-    // Write sampling rate
-    const int32_t samplingRate = parameters_->getSamplingRate();
-    if (!dumpFile.write(reinterpret_cast<const char *>(&samplingRate),
-            sizeof(samplingRate))) {
-        std::cerr << "Error: Unable to write sampling rate to dump file: "
-            << strerror(errno) << std::endl;
-        return;
+    // Clean up
+    std::cout << "Air scan results dumped successfully to file '" << dumpFile_
+        << "'." << std::endl;
+}
+
+/// @return Status of the operation.
+bool Scan::learnTarget(void) const {
+    // Frames are separated like for replays
+    ReplayParameters replayParameters(configuration_);
+    if (!replayParameters.load()) {
+        return false;
     }
 
-    // Write sample data
-    for (auto i = 0U; i < data_.size(); i++) {
-        const char data = static_cast<char>(data_.at(i));
-        if (!dumpFile.write(&data, sizeof(data))) {
-            std::cerr << "Error: Unable to write data to dump file: "
-                << strerror(errno) << std::endl;
-            return;
+    Learner learner(parameters_->getSamplingRate(),
+        replayParameters.getFrameGap());
+    for (const auto & run : getRuns()) {
+        learner.add(run);
+    }
+
+    if (!learner.learn()) {
+        std::cerr << "Error: No decodable radio frames found in air scan"
+            << std::endl;
+        return false;
+    }
+    learner.print(std::cout, Types::LEARNED_TARGET_NAME);
+
+    return true;
+}
+
+/// @return Status of the operation.
+bool Scan::printFrames(void) const {
+    // Frames are separated like for replays
+    ReplayParameters replayParameters(configuration_);
+    if (!replayParameters.load()) {
+        return false;
+    }
+
+    FrameDeduplicator deduplicator(parameters_->getSamplingRate(),
+        replayParameters.getFrameGap());
+    for (const auto & run : getRuns()) {
+        deduplicator.add(run);
+    }
+    deduplicator.finish();
+
+    // Unique frames are identified by the configured targets on request
+    if (outputFormat_ == Types::OutputFormat::IDENTIFY) {
+        TargetIndex targetIndex(configuration_);
+        if (!targetIndex.load(replayParameters.getFrameGap())) {
+            return false;
         }
+        deduplicator.print(std::cout, &targetIndex);
+    } else {
+        deduplicator.print(std::cout);
     }
 
-    // Clean up
-    std::cout << "Air scan results dumped successfully to file '" << dumpFile_
-        << "'." << std::endl;
+    return true;
 }
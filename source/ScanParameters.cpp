@@ -28,14 +28,16 @@
 ScanParameters::ScanParameters(const Configuration & configuration) :
         configuration_(configuration),
         gpioPin_(Types::INVALID_GPIO_PIN),
-        samplingRateUs_(Types::INVALID_PARAMETER) {
+        samplingRateUs_(Types::INVALID_PARAMETER),
+        compressDump_(true) {
     // Do nothing
 }
 
 /// @return Status of the operation.
 bool ScanParameters::load(void) {
     return loadGpioPin()
-        && loadSamplingRate();
+        && loadSamplingRate()
+        && loadCompressDump();
 }
 
 /// @return GPIO pin.
@@ -50,6 +52,11 @@ int32_t ScanParameters::getSamplingRate(void) const {
     return samplingRateUs_;
 }
 
+/// @return True if air scan dumps will be compressed, false otherwise.
+bool ScanParameters::getCompressDump(void) const {
+    return compressDump_;
+}
+
 /// @return True if successful, false otherwise.
 bool ScanParameters::loadGpioPin(void) {
     int32_t value;
@@ -91,3 +98,11 @@ bool ScanParameters::loadSamplingRate(void) {
 
     return true;
 }
+
+/// @return True if successful, false otherwise.
+bool ScanParameters::loadCompressDump(void) {
+    // Keep the default if the parameter is not configured
+    configuration_.getValue("scan", "compressDump", compressDump_);
+
+    return true;
+}
@@ -0,0 +1,293 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <iostream>
+
+#include <wiringPi.h>
+
+#include "Clock.h"
+#include "GpioBank.h"
+#include "GroupParameters.h"
+#include "Scene.h"
+
+/**
+ * @param configuration Reference of the configuration.
+ * @param names Target or group names, each must match a target configuration
+ *              entry or an entry of the 'groups' section.
+ */
+Scene::Scene(Configuration & configuration,
+        const std::vector<std::string> & names) :
+        Task(configuration),
+        names_(names),
+        arguments_(),
+        members_() {
+    // Do nothing
+}
+
+/**
+ * @param arguments Template variables qualified by the target name, e.g.
+ *                  outlet_template.system=FF1FF.
+ * @return True if all arguments are valid, false otherwise.
+ *
+ * The arguments are passed to the targets when the scene is started since
+ * group members are known only after the configuration has been loaded.
+ */
+bool Scene::setArguments(const std::vector<std::string> & arguments) {
+    for (const auto & argument : arguments) {
+        const size_t position = argument.find('.');
+        if ((position == std::string::npos) || (position == 0U)) {
+            std::cerr << "Error: Template variable '" << argument
+                << "' must be given as target.name=value for multiple "
+                "targets" << std::endl;
+            return false;
+        }
+    }
+    arguments_ = arguments;
+
+    return true;
+}
+
+/// @return Program exit code.
+int Scene::start(void) {
+    const uint64_t startUs = Clock::now();
+
+    if (gpioPin_ != Types::INVALID_GPIO_PIN) {
+        std::cerr << "Error: Parameter '-g' is not supported for multiple "
+            "targets" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (!loadMembers()) {
+        return EXIT_FAILURE;
+    }
+
+    // Encode all targets before setting up the GPIO to keep the time to the
+    // first edge short
+    std::map<uint8_t, std::vector<const Member *>> channels;
+    for (const auto & member : members_) {
+        if (!member.target->prepare()) {
+            return EXIT_FAILURE;
+        }
+        channels[member.target->getParameters().getGpioPin()].push_back(
+            &member);
+    }
+
+    std::vector<Types::Edge> edges;
+    std::map<uint8_t, uint64_t> airtimeUs;
+    uint32_t gpioPins = 0U;
+    for (const auto & channel : channels) {
+        for (const auto member : channel.second) {
+            airtimeUs[channel.first] += member->target->getFrameDuration()
+                * member->target->getParameters().getSendCommand();
+        }
+
+        const std::vector<std::vector<uint64_t>> framesUs = interleave(
+            channel.second);
+        for (size_t i = 0U; i < channel.second.size(); i++) {
+            const std::vector<Types::Edge> targetEdges =
+                channel.second[i]->target->getEdges(framesUs[i]);
+            edges.insert(edges.end(), targetEdges.begin(), targetEdges.end());
+        }
+        gpioPins |= 1U << channel.first;
+    }
+
+    std::stable_sort(edges.begin(), edges.end(),
+        [](const Types::Edge & a, const Types::Edge & b) {
+            return a.timeUs < b.timeUs;
+        });
+
+    if (!acquireAirtime(airtimeUs) || !setupGpio()) {
+        return EXIT_FAILURE;
+    }
+
+    // Send the radio frames of all targets
+    airControl(edges, gpioPins);
+
+    uint64_t totalAirtimeUs = 0U;
+    for (const auto & channel : airtimeUs) {
+        totalAirtimeUs += channel.second;
+    }
+    std::cout << "Transmitted " << members_.size() << " target(s) in "
+        << (Clock::now() - startUs) / 1000U << "ms (span "
+        << edges.back().timeUs / 1000U << "ms, airtime "
+        << totalAirtimeUs / 1000U << "ms)" << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @return True if successful, false otherwise.
+ *
+ * Each group is replaced by its members in the order configured. Template
+ * variables are passed to all targets of the given name.
+ */
+bool Scene::loadMembers(void) {
+    for (const auto & name : names_) {
+        if (!GroupParameters::isGroup(configuration_, name)) {
+            members_.push_back({ name, Types::INVALID_PARAMETER,
+                std::make_unique<Target>(Target(configuration_, name)) });
+            continue;
+        }
+
+        GroupParameters parameters(configuration_, name);
+        if (!parameters.load()) {
+            return false;
+        }
+        for (const auto & member : parameters.getMembers()) {
+            members_.push_back({ member.name, member.gapUs,
+                std::make_unique<Target>(Target(configuration_,
+                member.name)) });
+        }
+    }
+
+    for (const auto & argument : arguments_) {
+        const size_t position = argument.find('.');
+        const std::string name = argument.substr(0U, position);
+        if (std::none_of(members_.begin(), members_.end(),
+            [&name](const Member & member) { return member.name == name; })) {
+            std::cerr << "Error: Template variable '" << argument
+                << "' refers to unknown target " << name << std::endl;
+            return false;
+        }
+    }
+
+    for (auto & member : members_) {
+        std::vector<std::string> variables;
+        for (const auto & argument : arguments_) {
+            const size_t position = argument.find('.');
+            if (argument.compare(0U, position, member.name) == 0) {
+                variables.push_back(argument.substr(position + 1U));
+            }
+        }
+        if (!member.target->setArguments(variables)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @param members Targets sharing a GPIO pin in the order given.
+ * @return Start times of all transmissions per target (unit: microseconds).
+ *
+ * Transmissions are scheduled greedily at the earliest possible time, ties
+ * are resolved in the order of the targets. Each transmission is kept
+ * intact and the send delay of each target is kept as minimum period
+ * between its own transmissions, the send delay of a single target is not
+ * changed at all. Transmissions of different targets are separated by the
+ * send delay of the preceding target, which its receiver requires to detect
+ * the end of the frame. Only a gap configured for the following target
+ * overrides this separation.
+ */
+std::vector<std::vector<uint64_t>> Scene::interleave(
+        const std::vector<const Member *> & members) const {
+    std::vector<std::vector<uint64_t>> framesUs(members.size());
+    std::vector<uint64_t> earliestUs(members.size(), 0U);
+    size_t last = members.size();
+    uint64_t lastEndUs = 0U;
+
+    while (true) {
+        size_t next = members.size();
+        uint64_t nextUs = UINT64_MAX;
+        for (size_t i = 0U; i < members.size(); i++) {
+            const auto & parameters = members[i]->target->getParameters();
+            if (static_cast<int32_t>(framesUs[i].size())
+                == parameters.getSendCommand()) {
+                continue;
+            }
+
+            uint64_t gapUs = 0U;
+            if ((last != members.size()) && (last != i)) {
+                gapUs = static_cast<uint64_t>(
+                    (members[i]->gapUs != Types::INVALID_PARAMETER)
+                    ? members[i]->gapUs
+                    : members[last]->target->getParameters().getSendDelay());
+            }
+            const uint64_t startUs = std::max(earliestUs[i],
+                lastEndUs + gapUs);
+            if (startUs < nextUs) {
+                next = i;
+                nextUs = startUs;
+            }
+        }
+        if (next == members.size()) {
+            break;
+        }
+
+        const Target & target = *members[next]->target;
+        const uint64_t endUs = nextUs + target.getFrameDuration();
+        framesUs[next].push_back(nextUs);
+        earliestUs[next] = endUs + target.getParameters().getSendDelay();
+        last = next;
+        lastEndUs = endUs;
+    }
+
+    return framesUs;
+}
+
+/**
+ * @param edges Edges of all targets sorted by time.
+ * @param gpioPins GPIO pins of all targets, bit n for GPIO pin n.
+ *
+ * Consecutive edges within COALESCE_US of the first one are written at the
+ * same time unless a pin changes twice. The sleep targets absolute deadlines
+ * like for single targets.
+ */
+void Scene::airControl(const std::vector<Types::Edge> & edges,
+        const uint32_t gpioPins) const {
+    const GpioBank gpioBank;
+
+    for (uint8_t pin = 0U; pin < 32U; pin++) {
+        if ((gpioPins & (1U << pin)) != 0U) {
+            pinMode(pin, OUTPUT);
+        }
+    }
+
+    const uint64_t startUs = Clock::now();
+    size_t first = 0U;
+    while (first < edges.size()) {
+        uint32_t setMask = 0U;
+        uint32_t clearMask = 0U;
+        size_t last = first;
+        for (; (last < edges.size())
+            && (edges[last].timeUs <= edges[first].timeUs + COALESCE_US)
+            && (((setMask | clearMask) & (1U << edges[last].gpioPin)) == 0U);
+            last++) {
+            if (edges[last].level) {
+                setMask |= 1U << edges[last].gpioPin;
+            } else {
+                clearMask |= 1U << edges[last].gpioPin;
+            }
+        }
+
+        Clock::sleepUntil(startUs + edges[first].timeUs);
+        gpioBank.write(setMask, clearMask);
+        for (; first < last; first++) {
+            recordEdge(startUs + edges[first].timeUs, edges[first].level);
+        }
+    }
+
+    for (uint8_t pin = 0U; pin < 32U; pin++) {
+        if ((gpioPins & (1U << pin)) != 0U) {
+            pinMode(pin, INPUT);
+        }
+    }
+}
@@ -0,0 +1,282 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include <wiringPi.h>
+
+#include "Clock.h"
+#include "Learner.h"
+#include "ReplayParameters.h"
+#include "RunDetector.h"
+#include "SelfTest.h"
+
+/**
+ * @param configuration Reference of the configuration.
+ * @param name Target name string, must match a target configuration entry.
+ */
+SelfTest::SelfTest(Configuration & configuration, const std::string & name) :
+        Task(configuration),
+        target_(std::make_unique<Target>(Target(configuration, name))),
+        scanParameters_(nullptr),
+        samples_(),
+        samplesUs_() {
+    // Do nothing
+}
+
+/**
+ * @param arguments Template variables, e.g. system=FF1FF.
+ * @return True if all arguments are valid, false otherwise.
+ */
+bool SelfTest::setArguments(const std::vector<std::string> & arguments) {
+    return target_->setArguments(arguments);
+}
+
+/// @return Program exit code.
+int SelfTest::start(void) {
+    target_->setGpioPin(gpioPin_);
+    if (!target_->prepare()) {
+        return EXIT_FAILURE;
+    }
+
+    scanParameters_ = std::make_unique<ScanParameters>(
+        ScanParameters(configuration_));
+    if (!scanParameters_->load()) {
+        return EXIT_FAILURE;
+    } else if (scanParameters_->getGpioPin()
+        == target_->getParameters().getGpioPin()) {
+        std::cerr << "Error: Self-test requires a scan gpioPin different from "
+            "the target" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // The samples are allocated up front for the longest possible
+    // transmission so that capturing does not allocate
+    const size_t samples = (target_->getMaxDuration() + 2U * MARGIN_US)
+        / scanParameters_->getSamplingRate() + 1U;
+    samples_.reserve(samples);
+    samplesUs_.reserve(samples);
+
+    if (!target_->reserveAirtime() || !setupGpio()) {
+        return EXIT_FAILURE;
+    }
+    pinMode(scanParameters_->getGpioPin(), INPUT);
+
+    // Transmit and capture concurrently, the capture starts ahead of the
+    // first edge and stops after the last one
+    const uint64_t captureUs = Clock::now();
+    std::atomic<uint64_t> stopUs(UINT64_MAX);
+    std::thread capturer(&SelfTest::capture, this, captureUs,
+        std::cref(stopUs));
+    Clock::sleepUntil(captureUs + MARGIN_US);
+    target_->airControl();
+    stopUs = Clock::now() + MARGIN_US;
+    capturer.join();
+    target_->refundAirtime();
+    timing_ = target_->getTiming();
+
+    return (analyze() && decode()) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @param startUs Time of the first sample (unit: microseconds).
+ * @param stopUs Time after the last sample, updated while capturing (unit:
+ *               microseconds).
+ *
+ * Runs within its own thread, the samples are taken at absolute times like
+ * the edges of the target. The actual time of each sample is kept since
+ * reading the pin might be delayed.
+ */
+void SelfTest::capture(const uint64_t startUs,
+        const std::atomic<uint64_t> & stopUs) {
+    const uint8_t gpioPin = scanParameters_->getGpioPin();
+    const uint64_t samplingRateUs = scanParameters_->getSamplingRate();
+
+    for (uint64_t sampleUs = startUs; (samples_.size() < samples_.capacity())
+            && (sampleUs < stopUs); sampleUs += samplingRateUs) {
+        Clock::sleepUntil(sampleUs);
+        samples_.push_back((digitalRead(gpioPin) > 0) ? 1U : 0U);
+        samplesUs_.push_back(Clock::now());
+    }
+}
+
+/**
+ * @return True if a signal has been received, false otherwise.
+ *
+ * The transmitted edges are taken from the deadlines of all transmissions
+ * including listen-before-talk backoffs and retransmissions. The latency is
+ * the period from the first transmitted to the first received high edge.
+ * Each transmitted edge is matched to the received edge of the same level
+ * closest to its time plus the latency, within half of the
+ * shortest pulse or a sample. The edge errors are relative to the median
+ * latency of all matched edges since single edges are quantized by the
+ * sampling rate.
+ */
+bool SelfTest::analyze(void) const {
+    const uint64_t samplingRateUs = scanParameters_->getSamplingRate();
+
+    // Transmitted edges without repeated levels
+    std::vector<Types::Edge> transmitted;
+    uint64_t shortestUs = UINT64_MAX;
+    for (const auto & edge : target_->getTransmittedEdges()) {
+        const bool level = !transmitted.empty() && transmitted.back().level;
+        if (edge.level != level) {
+            if (!transmitted.empty()) {
+                shortestUs = std::min(shortestUs,
+                    edge.timeUs - transmitted.back().timeUs);
+            }
+            transmitted.push_back(edge);
+        }
+    }
+
+    // Received edges by level
+    std::vector<Types::Run> runs;
+    RunDetector::detect(samples_.data(), samples_.size(), runs);
+    std::vector<uint64_t> received[2];
+    bool level = false;
+    size_t position = 0U;
+    for (const auto & run : runs) {
+        if (run.level != level) {
+            level = run.level;
+            received[level].push_back(samplesUs_[position]);
+        }
+        position += run.samples;
+    }
+
+    std::cout << "Transmitted:    " << transmitted.size() << " edges on GPIO "
+        "pin " << +target_->getParameters().getGpioPin() << std::endl
+        << "Received:       " << received[false].size()
+        + received[true].size() << " edges on GPIO pin "
+        << +scanParameters_->getGpioPin() << std::endl;
+    if (transmitted.empty() || received[true].empty()) {
+        std::cerr << "Error: No signal received" << std::endl;
+        return false;
+    }
+
+    const int64_t latencyUs = static_cast<int64_t>(received[true].front())
+        - static_cast<int64_t>(transmitted.front().timeUs);
+    const int64_t toleranceUs = static_cast<int64_t>(std::max(shortestUs / 2U,
+        samplingRateUs));
+
+    std::vector<int64_t> offsetsUs;
+    for (const auto & edge : transmitted) {
+        const int64_t expectedUs = static_cast<int64_t>(edge.timeUs)
+            + latencyUs;
+        const std::vector<uint64_t> & edges = received[edge.level];
+        auto closest = std::lower_bound(edges.begin(), edges.end(),
+            static_cast<uint64_t>(std::max<int64_t>(0,
+            expectedUs - toleranceUs)));
+        if ((closest == edges.end())
+            || (static_cast<int64_t>(*closest) > expectedUs + toleranceUs)) {
+            continue;
+        }
+
+        // Prefer the following edge if it is closer
+        if ((closest + 1 != edges.end())
+            && (std::abs(static_cast<int64_t>(*(closest + 1)) - expectedUs)
+            < std::abs(static_cast<int64_t>(*closest) - expectedUs))) {
+            closest++;
+        }
+        offsetsUs.push_back(static_cast<int64_t>(*closest) - expectedUs
+            + latencyUs);
+    }
+
+    std::vector<int64_t> sortedUs(offsetsUs);
+    std::sort(sortedUs.begin(), sortedUs.end());
+    const int64_t medianUs = sortedUs.empty() ? latencyUs
+        : sortedUs[sortedUs.size() / 2U];
+    double sumUs = 0.0;
+    double sumSquaresUs = 0.0;
+    int64_t maximumUs = 0;
+    for (const int64_t offsetUs : offsetsUs) {
+        const int64_t errorUs = offsetUs - medianUs;
+        sumUs += std::abs(errorUs);
+        sumSquaresUs += static_cast<double>(errorUs) * errorUs;
+        maximumUs = std::max(maximumUs, std::abs(errorUs));
+    }
+    const size_t matched = offsetsUs.size();
+
+    std::cout << std::fixed << std::setprecision(1)
+        << "Latency:        " << latencyUs << "us first edge, " << medianUs
+        << "us median" << std::endl
+        << "Edge error:     mean " << ((matched != 0U) ? sumUs / matched : 0.0)
+        << "us, rms " << ((matched != 0U)
+        ? std::sqrt(sumSquaresUs / matched) : 0.0)
+        << "us, max " << maximumUs << "us" << std::endl
+        << "Missing edges:  " << transmitted.size() - matched << std::endl
+        << "Extra edges:    " << received[false].size()
+        + received[true].size() - matched << std::endl;
+
+    return true;
+}
+
+/**
+ * @return True if the air command has been received without bit errors,
+ *         false otherwise.
+ *
+ * Custom encodings cannot be decoded, their bit errors are not checked.
+ */
+bool SelfTest::decode(void) const {
+    const TargetParameters & parameters = target_->getParameters();
+    if (parameters.isCustomEncoding()) {
+        std::cout << "Bit errors:     not supported for custom encodings"
+            << std::endl;
+        return true;
+    }
+
+    // Frames are separated like for replays
+    ReplayParameters replayParameters(configuration_);
+    if (!replayParameters.load()) {
+        return false;
+    }
+
+    Learner learner(scanParameters_->getSamplingRate(),
+        replayParameters.getFrameGap());
+    std::vector<Types::Run> runs;
+    RunDetector::detect(samples_.data(), samples_.size(), runs);
+    for (const auto & run : runs) {
+        learner.add(run);
+    }
+
+    const std::string & airCommand = target_->getAirCommand();
+    size_t errors = airCommand.length();
+    if (learner.learn() && (learner.getAirCode() == parameters.getAirCode())) {
+        const std::string & decoded = learner.getAirCommand();
+        errors = std::max(decoded.length(), airCommand.length())
+            - std::min(decoded.length(), airCommand.length());
+        for (size_t i = 0U; i < std::min(decoded.length(),
+                airCommand.length()); i++) {
+            errors += (decoded[i] != airCommand[i]) ? 1U : 0U;
+        }
+        std::cout << "Decoded frames: " << learner.getFrames() << " of "
+            << parameters.getSendCommand() << std::endl;
+    } else {
+        std::cout << "Decoded frames: 0 of " << parameters.getSendCommand()
+            << std::endl;
+    }
+    std::cout << "Bit errors:     " << errors << " of " << airCommand.length()
+        << std::endl;
+
+    return errors == 0U;
+}
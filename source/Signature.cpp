@@ -0,0 +1,90 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "Signature.h"
+
+/**
+ * Durations are sorted, a new cluster starts at each duration exceeding the
+ * shortest duration of the current cluster by the cluster ratio.
+ *
+ * @param pulses Pulse sequence.
+ * @return FNV-1a hash of the pulse count and the sequence of levels and
+ *         cluster indexes.
+ */
+uint64_t Signature::hash(const std::vector<Types::Pulse> & pulses) {
+    const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+    const uint64_t FNV_PRIME = 1099511628211ULL;
+
+    std::vector<uint32_t> durations;
+    durations.reserve(pulses.size());
+    for (const auto & pulse : pulses) {
+        durations.push_back(pulse.durationUs);
+    }
+    std::sort(durations.begin(), durations.end());
+
+    // Shortest duration of each cluster
+    std::vector<uint32_t> clusters;
+    for (const auto durationUs : durations) {
+        if (clusters.empty() || (static_cast<uint64_t>(durationUs) * 100U
+                > static_cast<uint64_t>(clusters.back())
+                * CLUSTER_RATIO_PERCENT)) {
+            clusters.push_back(durationUs);
+        }
+    }
+
+    uint64_t hash = (FNV_OFFSET_BASIS ^ pulses.size()) * FNV_PRIME;
+    for (const auto & pulse : pulses) {
+        const uint64_t cluster = std::upper_bound(clusters.begin(),
+            clusters.end(), pulse.durationUs) - clusters.begin() - 1U;
+        hash = (hash ^ ((cluster << 1U) | (pulse.level ? 1U : 0U)))
+            * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/**
+ * @param a First pulse sequence.
+ * @param b Second pulse sequence.
+ * @param minToleranceUs Minimum tolerance of short pulses (unit:
+ *                       microseconds).
+ * @return True if the levels match and the durations differ by no more than
+ *         the tolerance, false otherwise.
+ */
+bool Signature::isMatching(const std::vector<Types::Pulse> & a,
+        const std::vector<Types::Pulse> & b, const uint32_t minToleranceUs) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+
+    for (auto i = 0U; i < a.size(); i++) {
+        const uint32_t longerUs = std::max(a[i].durationUs, b[i].durationUs);
+        const uint32_t shorterUs = std::min(a[i].durationUs, b[i].durationUs);
+        const uint32_t toleranceUs = std::max(
+            longerUs * TOLERANCE_PERCENT / 100U, minToleranceUs);
+        if ((a[i].level != b[i].level)
+                || (longerUs - shorterUs > toleranceUs)) {
+            return false;
+        }
+    }
+
+    return true;
+}
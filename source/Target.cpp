@@ -17,12 +17,17 @@
  * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <climits>
+#include <cmath>
 #include <iostream>
 #include <unistd.h>
 
 #include <wiringPi.h>
 
+#include "AirCodeTraits.h"
+#include "Clock.h"
 #include "Target.h"
 
 /**
@@ -32,17 +37,62 @@
 Target::Target(Configuration & configuration, const std::string & name) :
         Task(configuration),
         name_(name),
-        parameters_(nullptr) {
+        parameters_(nullptr),
+        variables_(),
+        fragments_(),
+        airCommand_(),
+        pulses_(),
+        scanParameters_(nullptr),
+        framesUs_() {
     // Do nothing
 }
 
+/**
+ * @param arguments Template variables, e.g. system=FF1FF.
+ * @return True if all arguments are valid, false otherwise.
+ */
+bool Target::setArguments(const std::vector<std::string> & arguments) {
+    for (const auto & argument : arguments) {
+        const size_t position = argument.find('=');
+        if ((position == std::string::npos) || (position == 0U)
+            || (position + 1U == argument.length())) {
+            std::cerr << "Error: Template variable '" << argument
+                << "' must be given as name=value" << std::endl;
+            return false;
+        } else if (!variables_.emplace(argument.substr(0U, position),
+            argument.substr(position + 1U)).second) {
+            std::cerr << "Error: Template variable '"
+                << argument.substr(0U, position) << "' is given multiple "
+                "times" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
 /// @return Program exit code.
 int Target::start(void) {
+    // Encode before setting up the GPIO to keep the time to the first edge
+    // short
+    if (!prepare() || !reserveAirtime() || !setupGpio()) {
+        return EXIT_FAILURE;
+    }
+
+    // Send the radio frame to control the target
+    const bool isSuccess = airControl();
+    refundAirtime();
+
+    return isSuccess ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// @return True if successful, false otherwise.
+bool Target::prepare(void) {
     // Check whether the target exists
     if (!configuration_.isValidSection(name_)) {
         std::cerr << "Error: Given target " << name_ << " cannot be found"
             << std::endl;
-        return EXIT_FAILURE;
+        return false;
     }
 
     assert(parameters_ == nullptr);
@@ -51,7 +101,7 @@ int Target::start(void) {
 
     // Load all parameters from the configuration
     if (!parameters_->load()) {
-        return EXIT_FAILURE;
+        return false;
     }
 
     // Get GPIO from the parameters unless overridden from the command line
@@ -60,162 +110,555 @@ int Target::start(void) {
     } else if (!isValidGpioPin(gpioPin_)) {
         std::cerr << "Error: Given GPIO pin " << +gpioPin_ << " is invalid"
             << std::endl;
-        return EXIT_FAILURE;
+        return false;
     }
 
-    // Send the radio frame to control the target
-    airControl();
+    // Listen-before-talk uses the radio receiver of the air scan
+    if (parameters_->getListenWindow() > 0) {
+        scanParameters_ = std::make_unique<ScanParameters>(
+            ScanParameters(configuration_));
+        if (!scanParameters_->load()) {
+            return false;
+        } else if (scanParameters_->getGpioPin() == gpioPin_) {
+            std::cerr << "Error: Configuration error (target " << name_
+                << "): listenWindow requires a scan gpioPin different from "
+                "the target" << std::endl;
+            return false;
+        }
+    }
+
+    return encode();
+}
 
-    return EXIT_SUCCESS;
+/// @return Target parameters.
+const TargetParameters & Target::getParameters(void) const {
+    assert(parameters_ != nullptr);
+    return *parameters_;
 }
 
-void Target::airControl(void) const {
-    void (Target::*sendAirCommand)(void) const = nullptr;
+/// @return Air command with all template variables substituted.
+const std::string & Target::getAirCommand(void) const {
+    return airCommand_;
+}
 
-    switch (parameters_->getAirCode()) {
-        case Types::AirCode::MANCHESTER:
-            sendAirCommand = &Target::sendAirCommandManchester;
-            break;
+/// @return Pulses of a single air command transmission.
+const std::vector<Types::Pulse> & Target::getPulses(void) const {
+    return pulses_;
+}
 
-        case Types::AirCode::REMOTE_CONTROLLED_OUTLET:
-            sendAirCommand = &Target::sendAirCommandRemoteControlledOutled;
-            break;
+/// @return Duration of a single air command transmission.
+uint64_t Target::getFrameDuration(void) const {
+    uint64_t durationUs = 0U;
 
-        case Types::AirCode::TORMATIC:
-            sendAirCommand = &Target::sendAirCommandTormatic;
-            break;
+    for (const auto & pulse : pulses_) {
+        durationUs += pulse.durationUs;
+    }
 
-        case Types::AirCode::MELITEC:
-            sendAirCommand = &Target::sendAirCommandMelitec;
-            break;
+    return durationUs;
+}
 
-        case Types::AirCode::MAX:
-        default:
-            assert(false);
-            break;
+/**
+ * @return Longest possible duration of the transmission (unit:
+ *         microseconds).
+ *
+ * Each transmission, including retransmissions, is followed by its send
+ * delay and may be deferred by all listen-before-talk attempts.
+ */
+uint64_t Target::getMaxDuration(void) const {
+    const uint64_t transmissions = parameters_->getSendCommand()
+        + parameters_->getMaxRetransmits();
+    uint64_t periodUs = getFrameDuration() + parameters_->getSendDelay();
+
+    if (scanParameters_ != nullptr) {
+        periodUs += LISTEN_ATTEMPTS * static_cast<uint64_t>(
+            parameters_->getListenWindow() + parameters_->getListenBackoff());
     }
 
-    pinMode(gpioPin_, OUTPUT);
+    return transmissions * periodUs;
+}
+
+/**
+ * @return Edges relative to the first edge, including the delays between
+ *         repeated transmissions.
+ *
+ * The timeline matches airControl().
+ */
+std::vector<Types::Edge> Target::getEdges(void) const {
+    std::vector<uint64_t> framesUs;
+    const uint64_t periodUs = getFrameDuration() + parameters_->getSendDelay();
 
     for (auto n = 0; n < parameters_->getSendCommand(); n++) {
-        (this->*sendAirCommand)();
+        framesUs.push_back(n * periodUs);
+    }
 
-        if (n != parameters_->getSendCommand() - 1) {
-            digitalWrite(gpioPin_, LOW);
-            usleep(parameters_->getSendDelay());
+    return getEdges(framesUs);
+}
+
+/**
+ * @param framesUs Start times of all transmissions, sorted and not
+ *                 overlapping (unit: microseconds).
+ * @return Edges of all transmissions, each followed by a low edge releasing
+ *         the signal.
+ */
+std::vector<Types::Edge> Target::getEdges(
+        const std::vector<uint64_t> & framesUs) const {
+    std::vector<Types::Edge> edges;
+
+    edges.reserve((pulses_.size() + 1U) * framesUs.size());
+    for (const uint64_t frameUs : framesUs) {
+        uint64_t timeUs = frameUs;
+        for (const auto & pulse : pulses_) {
+            edges.push_back({ timeUs, gpioPin_, pulse.level });
+            timeUs += pulse.durationUs;
         }
+        edges.push_back({ timeUs, gpioPin_, false });
+    }
+
+    return edges;
+}
+
+/**
+ * @return Edges of all transmissions, each followed by a low edge releasing
+ *         the signal (unit: microseconds).
+ *
+ * The start of each transmission is its deadline after listen-before-talk
+ * backoffs and late starts, corrupted transmissions are included.
+ */
+std::vector<Types::Edge> Target::getTransmittedEdges(void) const {
+    return getEdges(framesUs_);
+}
+
+/**
+ * @return True if the airtime has been taken, false otherwise.
+ *
+ * Retransmissions are reserved up front so that acquiring airtime never
+ * sleeps in the middle of a burst, see refundAirtime().
+ */
+bool Target::reserveAirtime(void) {
+    const uint64_t transmissions = parameters_->getSendCommand()
+        + parameters_->getMaxRetransmits();
+
+    return acquireAirtime({ { gpioPin_, getFrameDuration() * transmissions } });
+}
+
+/// Must be called once after airControl() if reserveAirtime() succeeded.
+void Target::refundAirtime(void) {
+    const uint32_t unused = static_cast<uint32_t>(
+        parameters_->getMaxRetransmits()) - timing_.retransmissions;
+
+    if (unused != 0U) {
+        releaseAirtime({ { gpioPin_, getFrameDuration() * unused } });
+    }
+}
+
+/**
+ * @return True if the air command has been transmitted without missed
+ *         deadlines at least once, false otherwise.
+ *
+ * Transmissions with an edge missing its deadline by more than the deadline
+ * tolerance are corrupted, e.g. if the process has been preempted. They do
+ * not count towards sendCommand and are repeated up to maxRetransmits times,
+ * whose airtime has been reserved by reserveAirtime().
+ */
+bool Target::airControl(void) {
+    std::minstd_rand random(static_cast<uint32_t>(Clock::now()));
+    const uint64_t toleranceUs = getDeadlineTolerance();
+    int32_t transmissions = 0;
+    int32_t validTransmissions = 0;
+
+    pinMode(gpioPin_, OUTPUT);
+    if (scanParameters_ != nullptr) {
+        pinMode(scanParameters_->getGpioPin(), INPUT);
+    }
+
+    // The start times are kept without allocating in between transmissions
+    framesUs_.clear();
+    framesUs_.reserve(static_cast<size_t>(parameters_->getSendCommand()
+        + parameters_->getMaxRetransmits()));
+
+    // Write the pin only on transitions and sleep until the absolute end of
+    // each pulse so that sleep errors do not accumulate
+    uint64_t deadlineUs = Clock::now();
+    while (transmissions < parameters_->getSendCommand()) {
+        if (scanParameters_ != nullptr) {
+            deadlineUs = listen(deadlineUs, random);
+        }
+        Clock::sleepUntil(deadlineUs);
+
+        // A late start only extends the preceding delay
+        deadlineUs = std::max(deadlineUs, Clock::now());
+        framesUs_.push_back(deadlineUs);
+        if (transmit(deadlineUs, toleranceUs)) {
+            validTransmissions++;
+            transmissions++;
+        } else {
+            timing_.corruptions++;
+            if (timing_.retransmissions < static_cast<uint32_t>(
+                parameters_->getMaxRetransmits())) {
+                timing_.retransmissions++;
+            } else {
+                transmissions++;
+            }
+        }
+        deadlineUs += parameters_->getSendDelay();
     }
 
     pinMode(gpioPin_, INPUT);
+
+    if (timing_.backoffs != 0U) {
+        std::cerr << "Warning: Channel busy, transmissions deferred "
+            << timing_.backoffs << " time(s)" << std::endl;
+    }
+    if (timing_.corruptions != 0U) {
+        std::cerr << "Warning: " << timing_.corruptions << " transmission(s) "
+            "missed their deadlines by more than " << toleranceUs << "us, "
+            << timing_.retransmissions << " retransmitted" << std::endl;
+    }
+    if (validTransmissions == 0) {
+        std::cerr << "Error: Air command has not been transmitted without "
+            "missed deadlines" << std::endl;
+        return false;
+    }
+
+    return true;
 }
 
+/**
+ * @return Maximum delay of an edge before its transmission is corrupted
+ *         (unit: microseconds).
+ *
+ * Unless configured a quarter of the shortest pulse is tolerated, but at
+ * least the scheduling jitter. Pulses of most encodings are far shorter than
+ * the jitter, which would otherwise corrupt most transmissions.
+ */
+uint64_t Target::getDeadlineTolerance(void) const {
+    if (parameters_->getDeadlineTolerance() != Types::INVALID_PARAMETER) {
+        return parameters_->getDeadlineTolerance();
+    }
 
-void Target::sendAirCommandManchester(void) const {
-    assert(parameters_->getAirCode() == Types::AirCode::MANCHESTER);
+    uint32_t shortestUs = UINT32_MAX;
+    for (const auto & pulse : pulses_) {
+        shortestUs = std::min(shortestUs, pulse.durationUs);
+    }
 
-    for (auto i = 0U; i < parameters_->getAirCommand().length(); i++) {
-        switch (parameters_->getAirCommand().at(i)) {
-            case 's':
-                digitalWrite(gpioPin_, LOW);
-                usleep(parameters_->getSyncLength());
-                break;
+    return std::max<uint64_t>(MIN_DEADLINE_TOLERANCE_US,
+        static_cast<uint64_t>(shortestUs) * DEADLINE_TOLERANCE_PERCENT / 100U);
+}
 
-            case 'S':
-                digitalWrite(gpioPin_, HIGH);
-                usleep(parameters_->getSyncLength());
-                break;
+/**
+ * @param deadlineUs Intended start of the transmission, updated to its end
+ *                   (unit: microseconds).
+ * @param toleranceUs Maximum delay of an edge (unit: microseconds).
+ * @return True if all edges met their deadlines, false if the transmission
+ *         is corrupted.
+ *
+ * The delay of each edge is compared to the delay of the previous edge, i.e.
+ * to the error of the pulse in between. A constant wakeup latency delays all
+ * edges alike without distorting any pulse. The transmission is completed
+ * even if corrupted so that it does not end with a truncated pulse, the
+ * signal is released by a final low edge.
+ */
+bool Target::transmit(uint64_t & deadlineUs, const uint64_t toleranceUs)
+        const {
+    bool isOnTime = true;
+    uint64_t previousDelayUs = 0U;
+    const auto check = [&](const uint64_t actualUs) {
+        const uint64_t delayUs = (actualUs > deadlineUs)
+            ? actualUs - deadlineUs : 0U;
+        if ((delayUs > previousDelayUs + toleranceUs)
+            || (delayUs + toleranceUs < previousDelayUs)) {
+            isOnTime = false;
+        }
+        previousDelayUs = delayUs;
+    };
+
+    for (const auto & pulse : pulses_) {
+        check(recordEdge(deadlineUs, pulse.level));
+        digitalWrite(gpioPin_, pulse.level ? HIGH : LOW);
+        deadlineUs += pulse.durationUs;
+        Clock::sleepUntil(deadlineUs);
+    }
+    check(recordEdge(deadlineUs, false));
+    digitalWrite(gpioPin_, LOW);
 
-            case '0':
-                // Falling edge in the middle of the pulse
-                digitalWrite(gpioPin_, HIGH);
-                usleep(parameters_->getDataLength() / 2);
-                digitalWrite(gpioPin_, LOW);
-                usleep(parameters_->getDataLength() / 2);
-                break;
+    return isOnTime;
+}
 
-            case '1':
-                // Rising edge in the middle of the pulse
-                digitalWrite(gpioPin_, LOW);
-                usleep(parameters_->getDataLength() / 2);
-                digitalWrite(gpioPin_, HIGH);
-                usleep(parameters_->getDataLength() / 2);
-                break;
+/**
+ * @param deadlineUs Intended start of the transmission (unit: microseconds).
+ * @param random Random number generator for the backoff delays.
+ * @return Start of the transmission (unit: microseconds).
+ *
+ * The listen window ends at the intended start, i.e. it overlaps the send
+ * delay. While the channel is busy the transmission is deferred by a random
+ * delay, after LISTEN_ATTEMPTS busy windows it is started regardless.
+ */
+uint64_t Target::listen(const uint64_t deadlineUs, std::minstd_rand & random)
+        const {
+    std::uniform_int_distribution<int32_t> backoff(0,
+        parameters_->getListenBackoff());
+    const uint64_t windowUs = parameters_->getListenWindow();
+    uint64_t startUs = deadlineUs;
+
+    for (auto attempt = 0; attempt < LISTEN_ATTEMPTS; attempt++) {
+        const uint64_t nowUs = Clock::now();
+        if (startUs < nowUs + windowUs) {
+            startUs = nowUs + windowUs;
         }
+        if (!isChannelBusy(startUs - windowUs, startUs)) {
+            return startUs;
+        }
+
+        timing_.backoffs++;
+        startUs = Clock::now() + windowUs + backoff(random);
     }
+
+    return Clock::now();
 }
 
-void Target::sendAirCommandRemoteControlledOutled(void) const {
-    assert(parameters_->getAirCode()
-        == Types::AirCode::REMOTE_CONTROLLED_OUTLET);
+/**
+ * @param beginUs Begin of the period (unit: microseconds).
+ * @param endUs End of the period (unit: microseconds).
+ * @return True if a high signal has been received for at least two
+ *         consecutive samples, false otherwise.
+ *
+ * Short high pulses are ignored since receivers output noise on an idle
+ * channel.
+ */
+bool Target::isChannelBusy(const uint64_t beginUs, const uint64_t endUs)
+        const {
+    const uint8_t gpioPin = scanParameters_->getGpioPin();
+    uint32_t highSamples = 0U;
+
+    for (uint64_t sampleUs = beginUs; sampleUs < endUs;
+            sampleUs += scanParameters_->getSamplingRate()) {
+        Clock::sleepUntil(sampleUs);
+        highSamples = (digitalRead(gpioPin) > 0) ? highSamples + 1U : 0U;
+        if (highSamples >= 2U) {
+            return true;
+        }
+    }
 
-    for (auto i = 0U; i < parameters_->getAirCommand().length(); i++) {
-        switch (parameters_->getAirCommand().at(i)) {
-            case '0':
-                // Falling edge after 25% of the pulse
-                digitalWrite(gpioPin_, HIGH);
-                usleep(parameters_->getDataLength() / 4);
-                digitalWrite(gpioPin_, LOW);
-                usleep((parameters_->getDataLength() / 4) * 3);
-                break;
+    return false;
+}
 
-            case '1':
-                // Falling edge after 75% of the pulse
-                digitalWrite(gpioPin_, HIGH);
-                usleep((parameters_->getDataLength() / 4) * 3);
-                digitalWrite(gpioPin_, LOW);
-                usleep(parameters_->getDataLength() / 4);
-                break;
+/**
+ * @return True if successful, false otherwise.
+ *
+ * Literal parts and fragments are compiled to pulses once and spliced, i.e.
+ * targets sharing fragments are not encoded element by element.
+ */
+bool Target::encode(void) {
+    for (const auto & part : parameters_->getAirCommandParts()) {
+        if (!part.isVariable) {
+            append(part.text);
+        } else if (!encodeVariable(part.text)) {
+            return false;
+        }
+    }
+
+    for (const auto & variable : variables_) {
+        bool isUsed = false;
+        for (const auto & part : parameters_->getAirCommandParts()) {
+            isUsed |= part.isVariable && (part.text == variable.first);
+        }
+        if (!isUsed) {
+            std::cerr << "Error: Target " << name_ << " has no template "
+                "variable '" << variable.first << "'" << std::endl;
+            return false;
         }
     }
+
+    return true;
 }
 
-void Target::sendAirCommandTormatic(void) const {
-    assert(parameters_->getAirCode() == Types::AirCode::TORMATIC);
+/**
+ * @param name Variable name.
+ * @return True if successful, false otherwise.
+ *
+ * The value is either the name of a fragment, a sequence of single character
+ * fragment names or a literal air command, in this order.
+ */
+bool Target::encodeVariable(const std::string & name) {
+    const auto variable = variables_.find(name);
+    if (variable == variables_.end()) {
+        std::cerr << "Error: Template variable '" << name << "' of target "
+            << name_ << " is undefined" << std::endl;
+        return false;
+    }
+    const std::string & value = variable->second;
 
-    for (auto i = 0U; i < parameters_->getAirCommand().length(); i++) {
-        switch (parameters_->getAirCommand().at(i)) {
-            case '0':
-                // Falling edge after 33% of the pulse
-                digitalWrite(gpioPin_, HIGH);
-                usleep(parameters_->getDataLength() / 3);
-                digitalWrite(gpioPin_, LOW);
-                usleep((parameters_->getDataLength() / 3) * 2);
-                break;
+    std::string fragment;
+    if (parameters_->getFragment(value, fragment)) {
+        append(fragment);
+        return true;
+    }
 
-            case '1':
-                // Falling edge after 33% of the pulse, another rising edge
-                // after 66%
-                digitalWrite(gpioPin_, HIGH);
-                usleep(parameters_->getDataLength() / 3);
-                digitalWrite(gpioPin_, LOW);
-                usleep(parameters_->getDataLength() / 3);
-                digitalWrite(gpioPin_, HIGH);
-                usleep(parameters_->getDataLength() / 3);
-                break;
+    bool isFragments = true;
+    for (const char character : value) {
+        isFragments &= parameters_->getFragment(std::string(1U, character),
+            fragment);
+    }
+    if (isFragments) {
+        for (const char character : value) {
+            parameters_->getFragment(std::string(1U, character), fragment);
+            append(fragment);
         }
+        return true;
     }
+
+    if (value.find_first_not_of(parameters_->getAlphabet())
+        != std::string::npos) {
+        std::cerr << "Error: Template variable '" << name << "' is neither a "
+            "fragment nor a valid air command" << std::endl;
+        return false;
+    }
+    append(value);
+
+    return true;
 }
 
-void Target::sendAirCommandMelitec(void) const {
-    assert(parameters_->getAirCode() == Types::AirCode::MELITEC);
+/**
+ * @param airCommand Sequence string of data and sync elements.
+ * @return Pulses of the air command.
+ */
+const std::vector<Types::Pulse> & Target::compile(
+        const std::string & airCommand) {
+    const auto cached = fragments_.find(airCommand);
+    if (cached != fragments_.end()) {
+        return cached->second;
+    }
 
-    for (auto i = 0U; i < parameters_->getAirCommand().length(); i++) {
-        switch (parameters_->getAirCommand().at(i)) {
-            case '0':
-                // Falling edge after 33% of the pulse
-                digitalWrite(gpioPin_, HIGH);
-                usleep(parameters_->getDataLength() / 3);
-                digitalWrite(gpioPin_, LOW);
-                usleep((parameters_->getDataLength() / 3) * 2);
+    std::vector<Types::Pulse> pulses;
+    if (parameters_->isCustomEncoding()) {
+        pulses = encode(parameters_->getEncoding(), airCommand);
+    } else {
+        switch (parameters_->getAirCode()) {
+            case Types::AirCode::MANCHESTER:
+                pulses = encode<Types::AirCode::MANCHESTER>(airCommand);
                 break;
 
-            case 'S':
-                // Falling edge after 66% of the pulse
-                digitalWrite(gpioPin_, HIGH);
-                usleep((parameters_->getSyncLength() / 3) * 2);
-                digitalWrite(gpioPin_, LOW);
-                usleep(parameters_->getSyncLength() / 3);
+            case Types::AirCode::REMOTE_CONTROLLED_OUTLET:
+                pulses = encode<Types::AirCode::REMOTE_CONTROLLED_OUTLET>(
+                    airCommand);
+                break;
+
+            case Types::AirCode::TORMATIC:
+                pulses = encode<Types::AirCode::TORMATIC>(airCommand);
+                break;
+
+            case Types::AirCode::MELITEC:
+                pulses = encode<Types::AirCode::MELITEC>(airCommand);
+                break;
+
+            case Types::AirCode::MAX:
+            default:
+                assert(false);
                 break;
         }
     }
+
+    return fragments_.emplace(airCommand, pulses).first->second;
+}
+
+/// @param airCommand Sequence string of data and sync elements.
+void Target::append(const std::string & airCommand) {
+    splice(compile(airCommand));
+    airCommand_ += airCommand;
+}
+
+/**
+ * @param pulses Pulses to be appended.
+ *
+ * Pulses of the same level at the splice point are merged like within a
+ * fragment.
+ */
+void Target::splice(const std::vector<Types::Pulse> & pulses) {
+    auto pulse = pulses.begin();
+    if ((pulse != pulses.end()) && !pulses_.empty()
+        && (pulses_.back().level == pulse->level)) {
+        pulses_.back().durationUs += pulse->durationUs;
+        pulse++;
+    }
+    pulses_.insert(pulses_.end(), pulse, pulses.end());
+}
+
+/**
+ * The symbols and their segment fractions are known at compile time, the
+ * lookup and the arithmetic are folded per air code. Adjacent segments of the
+ * same level are merged into a single pulse.
+ *
+ * @tparam CODE Air code of the target.
+ * @param airCommand Sequence string of data and sync elements.
+ * @return Pulses of the air command.
+ */
+template <Types::AirCode::AirCode_ CODE>
+std::vector<Types::Pulse> Target::encode(const std::string & airCommand)
+        const {
+    using Traits = AirCodeTraits<CODE>;
+    const uint32_t TWELFTHS = 12U;
+
+    const uint32_t dataLengthUs = parameters_->getDataLength();
+    const uint32_t syncLengthUs = parameters_->getSyncLength();
+    std::vector<Types::Pulse> pulses;
+
+    for (const char character : airCommand) {
+        for (const auto & symbol : Traits::SYMBOLS) {
+            if (symbol.character != character) {
+                continue;
+            }
+
+            for (const auto & segment : symbol) {
+                const uint32_t durationUs = (segment.isSync ? syncLengthUs
+                    : dataLengthUs) * segment.twelfths / TWELFTHS;
+                if (!pulses.empty()
+                    && (pulses.back().level == segment.level)) {
+                    pulses.back().durationUs += durationUs;
+                } else {
+                    pulses.push_back({ segment.level, durationUs });
+                }
+            }
+            break;
+        }
+    }
+
+    return pulses;
+}
+
+/**
+ * The segments of all symbols are compiled to pulse durations once, the air
+ * command is encoded by splicing them like for the built-in air codes.
+ *
+ * @param encoding Custom encoding of the target.
+ * @param airCommand Sequence string of data and sync elements.
+ * @return Pulses of the air command.
+ */
+std::vector<Types::Pulse> Target::encode(const EncodingParameters & encoding,
+        const std::string & airCommand) const {
+    const uint32_t dataLengthUs = parameters_->getDataLength();
+    const uint32_t syncLengthUs = parameters_->getSyncLength();
+
+    std::vector<Types::Pulse> symbols[UCHAR_MAX + 1];
+    for (const auto & symbol : encoding.getSymbols()) {
+        for (const auto & segment : symbol.segments) {
+            symbols[static_cast<unsigned char>(symbol.character)].push_back({
+                segment.level, static_cast<uint32_t>(std::lround(
+                (symbol.isSync ? syncLengthUs : dataLengthUs)
+                * segment.fraction)) });
+        }
+    }
+
+    std::vector<Types::Pulse> pulses;
+    for (const char character : airCommand) {
+        for (const auto & pulse : symbols[static_cast<unsigned char>(
+                character)]) {
+            if (!pulses.empty() && (pulses.back().level == pulse.level)) {
+                pulses.back().durationUs += pulse.durationUs;
+            } else {
+                pulses.push_back(pulse);
+            }
+        }
+    }
+
+    return pulses;
 }
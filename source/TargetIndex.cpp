@@ -0,0 +1,124 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <iostream>
+
+#include "Signature.h"
+#include "Target.h"
+#include "TargetIndex.h"
+
+/// @param configuration Reference of the configuration.
+TargetIndex::TargetIndex(Configuration & configuration) :
+        configuration_(configuration),
+        entries_(),
+        index_() {
+    // Do nothing
+}
+
+/**
+ * Target sections are the sections defining an air command. Targets which
+ * cannot be encoded are reported and skipped.
+ *
+ * @param frameGapUs Minimum silence period separating two frames (unit:
+ *                   microseconds).
+ * @return True if at least one target has been indexed, false otherwise.
+ */
+bool TargetIndex::load(const int32_t frameGapUs) {
+    for (const auto & section : configuration_.getSections()) {
+        std::string airCommand;
+        if ((section == "target")
+                || !configuration_.getValue(section, "airCommand", airCommand)
+                || (airCommand.find('{') != std::string::npos)) {
+            continue;
+        }
+
+        Target target(configuration_, section);
+        if (target.prepare()) {
+            add(section, target.getPulses(), frameGapUs);
+        }
+    }
+
+    if (entries_.empty()) {
+        std::cerr << "Error: No target sections found to identify frames with"
+            << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @param pulses Pulses of a received frame, starting and ending with a high
+ *               pulse.
+ * @param samplingRateUs Delay between two samples of the received frame
+ *                       (unit: microseconds).
+ * @return Names of the matching targets, empty if the frame is unknown.
+ */
+std::vector<std::string> TargetIndex::identify(
+        const std::vector<Types::Pulse> & pulses,
+        const int32_t samplingRateUs) const {
+    const uint32_t toleranceUs = std::max(MIN_TOLERANCE_US,
+        2U * static_cast<uint32_t>(samplingRateUs));
+    std::vector<std::string> names;
+
+    const auto range = index_.equal_range(Signature::hash(pulses));
+    for (auto it = range.first; it != range.second; ++it) {
+        const Entry & entry = entries_[it->second];
+        if (Signature::isMatching(entry.pulses, pulses, toleranceUs)
+                && (std::find(names.begin(), names.end(), entry.name)
+                == names.end())) {
+            names.push_back(entry.name);
+        }
+    }
+
+    return names;
+}
+
+/**
+ * The pulses are split into frames like received ones, i.e. at low pulses
+ * lasting for at least the frame gap. Low pulses around the frames are
+ * dropped since they are hidden in the silence gaps.
+ *
+ * @param name Target section name.
+ * @param pulses Pulses of a single air command transmission.
+ * @param frameGapUs Minimum silence period separating two frames (unit:
+ *                   microseconds).
+ */
+void TargetIndex::add(const std::string & name,
+        const std::vector<Types::Pulse> & pulses, const int32_t frameGapUs) {
+    std::vector<Types::Pulse> frame;
+
+    for (auto i = 0U; i <= pulses.size(); i++) {
+        const bool isGap = (i == pulses.size()) || (!pulses[i].level
+            && (pulses[i].durationUs >= static_cast<uint32_t>(frameGapUs)));
+        if (isGap) {
+            while (!frame.empty() && !frame.back().level) {
+                frame.pop_back();
+            }
+            if (!frame.empty()) {
+                index_.emplace(Signature::hash(frame), entries_.size());
+                entries_.push_back({ name, frame });
+                frame.clear();
+            }
+        } else if (!frame.empty() || pulses[i].level) {
+            frame.push_back(pulses[i]);
+        }
+    }
+}
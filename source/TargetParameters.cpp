@@ -17,9 +17,11 @@
  * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
+#include "AirCodeTraits.h"
 #include "TargetParameters.h"
 #include "Task.h"
 
@@ -35,9 +37,16 @@ TargetParameters::TargetParameters(const Configuration & configuration,
         dataLengthUs_(Types::INVALID_PARAMETER),
         syncLengthUs_(Types::INVALID_PARAMETER),
         airCode_(Types::AirCode::MAX),
+        encoding_(nullptr),
         airCommand_(),
+        airCommandParts_(),
+        fragments_(),
         sendCommand_(Types::INVALID_PARAMETER),
-        sendDelayUs_(Types::INVALID_PARAMETER) {
+        sendDelayUs_(Types::INVALID_PARAMETER),
+        listenWindowUs_(0),
+        listenBackoffUs_(DEFAULT_LISTEN_BACKOFF_US),
+        deadlineToleranceUs_(Types::INVALID_PARAMETER),
+        maxRetransmits_(DEFAULT_MAX_RETRANSMITS) {
     // Do nothing
 }
 
@@ -48,8 +57,11 @@ bool TargetParameters::load(void) {
         && loadSyncLength()
         && loadAirCode()
         && loadAirCommand()
+        && loadFragments()
         && loadSendCommand()
-        && loadSendDelay();
+        && loadSendDelay()
+        && loadListen()
+        && loadRetransmit();
 }
 
 /// @return GPIO pin.
@@ -76,12 +88,52 @@ Types::AirCode::AirCode_ TargetParameters::getAirCode(void) const {
     return airCode_;
 }
 
+/// @return True if a custom encoding is used, false otherwise.
+bool TargetParameters::isCustomEncoding(void) const {
+    return encoding_ != nullptr;
+}
+
+/// @return Custom encoding.
+const EncodingParameters & TargetParameters::getEncoding(void) const {
+    assert(encoding_ != nullptr);
+    return *encoding_;
+}
+
 /// @return Sequence string of data and sync elements to be transmitted.
 std::string TargetParameters::getAirCommand(void) const {
     assert(airCommand_.length() != 0U);
     return airCommand_;
 }
 
+/// @return Literal and variable parts of the air command.
+const std::vector<TargetParameters::Part> &
+        TargetParameters::getAirCommandParts(void) const {
+    assert(!airCommandParts_.empty());
+    return airCommandParts_;
+}
+
+/// @return Data and sync elements valid for the air code.
+std::string TargetParameters::getAlphabet(void) const {
+    return (encoding_ != nullptr) ? encoding_->getAlphabet()
+        : AirCodes::getAlphabet(airCode_);
+}
+
+/**
+ * @param name Fragment name.
+ * @param fragment Data and sync elements of the fragment.
+ * @return True if the fragment exists, false otherwise.
+ */
+bool TargetParameters::getFragment(const std::string & name,
+        std::string & fragment) const {
+    const auto it = fragments_.find(name);
+    if (it == fragments_.end()) {
+        return false;
+    }
+
+    fragment = it->second;
+    return true;
+}
+
 /// @return Number of times the air command will be transmitted.
 int32_t TargetParameters::getSendCommand(void) const {
     assert(sendCommand_ != Types::INVALID_PARAMETER);
@@ -94,6 +146,29 @@ int32_t TargetParameters::getSendDelay(void) const {
     return sendDelayUs_;
 }
 
+/// @return Period the channel is listened to, zero if disabled.
+int32_t TargetParameters::getListenWindow(void) const {
+    return listenWindowUs_;
+}
+
+/// @return Maximum random delay before listening again to a busy channel.
+int32_t TargetParameters::getListenBackoff(void) const {
+    return listenBackoffUs_;
+}
+
+/**
+ * @return Maximum delay of an edge before its transmission is corrupted,
+ *         Types::INVALID_PARAMETER if not configured.
+ */
+int32_t TargetParameters::getDeadlineTolerance(void) const {
+    return deadlineToleranceUs_;
+}
+
+/// @return Maximum number of retransmissions of corrupted transmissions.
+int32_t TargetParameters::getMaxRetransmits(void) const {
+    return maxRetransmits_;
+}
+
 /// @return True if successful, false otherwise.
 bool TargetParameters::loadGpioPin(void) {
     int32_t value;
@@ -154,6 +229,17 @@ bool TargetParameters::loadSyncLength(void) {
 /// @return True if successful, false otherwise.
 bool TargetParameters::loadAirCode(void) {
     int32_t airCode;
+    std::string encoding;
+
+    // Custom encodings are referenced by name, the target section takes
+    // precedence over the defaults
+    const std::string section = (configuration_.getSetting(name_, "airCode")
+        != nullptr) ? name_ : "target";
+    if (configuration_.getValue(section, "airCode", encoding)) {
+        encoding_ = std::make_unique<EncodingParameters>(
+            EncodingParameters(configuration_, encoding));
+        return encoding_->load();
+    }
 
     if (!getValue(name_, "airCode", airCode)) {
         return false;
@@ -169,7 +255,12 @@ bool TargetParameters::loadAirCode(void) {
     return true;
 }
 
-/// @return True if successful, false otherwise.
+/**
+ * @return True if successful, false otherwise.
+ *
+ * The air command may be a template containing variables in braces, e.g.
+ * "{system}{receiver}0", which are substituted on execution.
+ */
 bool TargetParameters::loadAirCommand(void) {
     if (!getValue(name_, "airCommand", airCommand_)) {
         return false;
@@ -179,37 +270,90 @@ bool TargetParameters::loadAirCommand(void) {
         std::cerr << "Error: Configuration error (target " << name_
             << "): airCommand is undefined" << std::endl;
         return false;
-    } else {
-        std::string elements;
+    }
 
-        switch (airCode_) {
-            case Types::AirCode::MANCHESTER:
-                elements = "01sS";
-                break;
+    const std::string elements = getAlphabet();
+    size_t position = 0U;
+    while (position < airCommand_.length()) {
+        if (airCommand_[position] == '{') {
+            const size_t end = airCommand_.find('}', position);
+            if ((end == std::string::npos) || (end == position + 1U)) {
+                std::cerr << "Error: Configuration error (target " << name_
+                    << "): airCommand contains invalid variable at position "
+                    << position+1 << std::endl;
+                return false;
+            }
+            airCommandParts_.push_back({ true,
+                airCommand_.substr(position + 1U, end - position - 1U) });
+            position = end + 1U;
+            continue;
+        }
 
-            case Types::AirCode::REMOTE_CONTROLLED_OUTLET:
-                // Intentional fall-through
-            case Types::AirCode::TORMATIC:
-                elements = "01";
-                break;
+        const size_t end = std::min(airCommand_.find('{', position),
+            airCommand_.length());
+        const size_t illegal = airCommand_.find_first_not_of(elements,
+            position);
+        if (illegal < end) {
+            std::cerr << "Error: Configuration error (target " << name_
+                << "): airCommand contains illegal character at position "
+                << illegal+1 << std::endl;
+            return false;
+        }
+        airCommandParts_.push_back({ false,
+            airCommand_.substr(position, end - position) });
+        position = end;
+    }
 
-            case Types::AirCode::MELITEC:
-                elements = "0S";
-                break;
+    return true;
+}
 
-            case Types::AirCode::MAX:
-            default:
-                assert(false);
-                break;
+/**
+ * @return True if successful, false otherwise.
+ *
+ * Fragments are given as a list of name and air command pairs, e.g.
+ * ( ( "on", "1100" ), ( "F", "01" ) ).
+ */
+bool TargetParameters::loadFragments(void) {
+    const libconfig::Setting * fragments = configuration_.getSetting(name_,
+        "fragments");
+    if (fragments == nullptr) {
+        fragments = configuration_.getSetting("target", "fragments");
+    }
+    if (fragments == nullptr) {
+        return true;
+    }
+
+    if (!fragments->isList()) {
+        std::cerr << "Error: Configuration error (target " << name_
+            << "): fragments must be a list" << std::endl;
+        return false;
+    }
+
+    const std::string elements = getAlphabet();
+    for (auto i = 0; i < fragments->getLength(); i++) {
+        const libconfig::Setting & fragment = (*fragments)[i];
+        if (!fragment.isAggregate() || (fragment.getLength() != 2)
+            || (fragment[0].getType() != libconfig::Setting::TypeString)
+            || (fragment[1].getType() != libconfig::Setting::TypeString)) {
+            std::cerr << "Error: Configuration error (target " << name_
+                << "): fragment " << i + 1 << " must be a pair of name and "
+                "air command" << std::endl;
+            return false;
         }
 
-        const size_t position = airCommand_.find_first_not_of(elements);
-        if (position != std::string::npos) {
+        const std::string name = fragment[0];
+        const std::string value = fragment[1];
+        if (name.empty() || value.empty()) {
             std::cerr << "Error: Configuration error (target " << name_
-                << "): airCommand contains illegal character at position "
-                << position+1 << std::endl;
+                << "): fragment " << i + 1 << " is undefined" << std::endl;
+            return false;
+        } else if (value.find_first_not_of(elements) != std::string::npos) {
+            std::cerr << "Error: Configuration error (target " << name_
+                << "): fragment '" << name << "' contains illegal character"
+                << std::endl;
             return false;
         }
+        fragments_[name] = value;
     }
 
     return true;
@@ -248,3 +392,60 @@ bool TargetParameters::loadSendDelay(void) {
 
     return true;
 }
+
+/**
+ * @return True if successful, false otherwise.
+ *
+ * Both parameters are optional, the target section takes precedence over
+ * the defaults.
+ */
+bool TargetParameters::loadListen(void) {
+    if (!configuration_.getValue(name_, "listenWindow", listenWindowUs_)) {
+        configuration_.getValue("target", "listenWindow", listenWindowUs_);
+    }
+    if (!configuration_.getValue(name_, "listenBackoff", listenBackoffUs_)) {
+        configuration_.getValue("target", "listenBackoff", listenBackoffUs_);
+    }
+
+    if (listenWindowUs_ < 0) {
+        std::cerr << "Error: Configuration error (target " << name_
+            << "): listenWindow is invalid" << std::endl;
+        return false;
+    } else if (listenBackoffUs_ <= 0) {
+        std::cerr << "Error: Configuration error (target " << name_
+            << "): listenBackoff is invalid" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @return True if successful, false otherwise.
+ *
+ * Both parameters are optional, the target section takes precedence over
+ * the defaults.
+ */
+bool TargetParameters::loadRetransmit(void) {
+    if (!configuration_.getValue(name_, "deadlineTolerance",
+            deadlineToleranceUs_)) {
+        configuration_.getValue("target", "deadlineTolerance",
+            deadlineToleranceUs_);
+    }
+    if (!configuration_.getValue(name_, "maxRetransmits", maxRetransmits_)) {
+        configuration_.getValue("target", "maxRetransmits", maxRetransmits_);
+    }
+
+    if ((deadlineToleranceUs_ != Types::INVALID_PARAMETER)
+        && (deadlineToleranceUs_ <= 0)) {
+        std::cerr << "Error: Configuration error (target " << name_
+            << "): deadlineTolerance is invalid" << std::endl;
+        return false;
+    } else if (maxRetransmits_ < 0) {
+        std::cerr << "Error: Configuration error (target " << name_
+            << "): maxRetransmits is invalid" << std::endl;
+        return false;
+    }
+
+    return true;
+}
@@ -17,19 +17,31 @@
  * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <iostream>
+
 #include <wiringPi.h>
 
+#include "Airtime.h"
+#include "AirtimeParameters.h"
 #include "Task.h"
 
+bool Task::isGpioDisabled_ = false;
+
 /// @param configuration Reference of the configuration.
 Task::Task(Configuration & configuration) :
-        configuration_(configuration) {
+        configuration_(configuration),
+        trace_(nullptr),
+        timing_({ 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U }) {
     // Do nothing
 }
 
 /**
  * @param gpioPin GPIO pin to be checked.
  * @return True if the given GPIO pin is valid, false otherwise.
+ *
+ * The board revision is detected once only since it requires parsing
+ * /proc/cpuinfo. If the GPIO access is disabled, the board revision is not
+ * detected and the GPIO pins of all board revisions are valid.
  */
 bool Task::isValidGpioPin(const uint8_t gpioPin) {
     if (gpioPin == Types::INVALID_GPIO_PIN) {
@@ -40,10 +52,27 @@ bool Task::isValidGpioPin(const uint8_t gpioPin) {
         18U, 21U, 22U, 23U, 24U, 10U, 9U, 25U, 11U, 8U, 7U };
     const uint8_t VALID_GPIO_PINS_HW_REV2[] = { 2U, 3U, 4U, 14U, 15U, 17U,
         18U, 27U, 22U, 23U, 24U, 10U, 9U, 25U, 11U, 8U, 7U };
+
+    if (isGpioDisabled_) {
+        for (const uint8_t pin : VALID_GPIO_PINS_HW_REV1) {
+            if (gpioPin == pin) {
+                return true;
+            }
+        }
+        for (const uint8_t pin : VALID_GPIO_PINS_HW_REV2) {
+            if (gpioPin == pin) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static const int BOARD_REVISION = piBoardRev();
+
     const uint8_t * validGpioPins;
     uint8_t VALID_GPIO_PINS_COUNT;
 
-    if (piBoardRev() == 1) {
+    if (BOARD_REVISION == 1) {
         validGpioPins = VALID_GPIO_PINS_HW_REV1;
         VALID_GPIO_PINS_COUNT = sizeof(VALID_GPIO_PINS_HW_REV1);
     } else {
@@ -57,7 +86,108 @@ bool Task::isValidGpioPin(const uint8_t gpioPin) {
     return pin < VALID_GPIO_PINS_COUNT;
 }
 
+/**
+ * GPIO pins are validated without detecting the board revision afterwards
+ * and any GPIO setup fails.
+ */
+void Task::disableGpio(void) {
+    isGpioDisabled_ = true;
+}
+
 /// @param gpioPin GPIO pin.
 void Task::setGpioPin(const uint8_t gpioPin) {
     gpioPin_ = gpioPin;
 }
+
+/// @param traceFile Trace file name, an empty string disables tracing.
+void Task::setTraceFile(const std::string & traceFile) {
+    trace_ = traceFile.empty() ? nullptr : std::make_unique<Trace>(traceFile);
+}
+
+/**
+ * @param arguments Positional command line arguments.
+ * @return True if the arguments are supported by the task, false otherwise.
+ *
+ * Tasks do not support any arguments unless overridden.
+ */
+bool Task::setArguments(const std::vector<std::string> & arguments) {
+    if (!arguments.empty()) {
+        std::cerr << "Error: Unexpected argument '" << arguments.front()
+            << "'" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/// @return Status of the operation.
+bool Task::flushTrace(void) const {
+    return (trace_ == nullptr) || trace_->flush();
+}
+
+/// @return Timing statistics of all edges.
+const Task::Timing & Task::getTiming(void) const {
+    return timing_;
+}
+
+/**
+ * @return Status of the operation.
+ *
+ * No port re-mapping is used, i.e. Broadcom GPIO numbers. The setup time is
+ * recorded in the timing statistics.
+ */
+bool Task::setupGpio(void) {
+    timing_.gpioSetupUs = Clock::now();
+    if (isGpioDisabled_ || (wiringPiSetupGpio() < 0)) {
+        std::cerr << "Error: GPIO setup failed" << std::endl;
+        return false;
+    }
+    timing_.gpioReadyUs = Clock::now();
+
+    return true;
+}
+
+/**
+ * @param airtimeUs Airtime per GPIO pin (unit: microseconds).
+ * @return Status of the operation.
+ *
+ * The airtime is not limited unless configured.
+ */
+bool Task::acquireAirtime(const std::map<uint8_t, uint64_t> & airtimeUs) {
+    AirtimeParameters parameters(configuration_);
+    if (!parameters.load()) {
+        return false;
+    } else if (parameters.getStateFile().empty()) {
+        return true;
+    }
+
+    Airtime airtime(parameters);
+    if (!airtime.acquire(airtimeUs)) {
+        return false;
+    }
+    for (const auto & request : airtimeUs) {
+        timing_.airtimeUs += request.second;
+    }
+
+    return true;
+}
+
+/**
+ * @param airtimeUs Airtime per GPIO pin acquired by acquireAirtime() but not
+ *                  used (unit: microseconds).
+ *
+ * A failure only costs budget, the transmission has been completed already.
+ */
+void Task::releaseAirtime(const std::map<uint8_t, uint64_t> & airtimeUs) {
+    AirtimeParameters parameters(configuration_);
+    if (!parameters.load() || parameters.getStateFile().empty()) {
+        return;
+    }
+
+    Airtime airtime(parameters);
+    if (airtime.release(airtimeUs)) {
+        for (const auto & request : airtimeUs) {
+            timing_.airtimeUs -= request.second;
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <iostream>
+
+#include "Trace.h"
+
+/**
+ * @param traceFile Reference of the trace file name.
+ *
+ * The ring is allocated and initialized completely here so that no page
+ * faults occur while recording.
+ */
+Trace::Trace(const std::string & traceFile) :
+        traceFile_(traceFile),
+        edges_(CAPACITY, { 0U, 0U, false }),
+        count_(0U) {
+    // Do nothing
+}
+
+/**
+ * @return Status of the operation.
+ *
+ * The CSV file contains one line per edge with the edge number, the signal
+ * level, the intended and actual time relative to the intended time of the
+ * first edge and the deviation between both (unit: microseconds).
+ */
+bool Trace::flush(void) const {
+    std::ofstream file;
+
+    file.open(traceFile_, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error: Trace file '" << traceFile_ << "' cannot be "
+            "created" << std::endl;
+        return false;
+    }
+
+    if (count_ > CAPACITY) {
+        std::cerr << "Warning: Trace buffer overflow, the oldest "
+            << count_ - CAPACITY << " edge(s) have been dropped" << std::endl;
+    }
+
+    const uint64_t first = (count_ > CAPACITY) ? count_ - CAPACITY : 0U;
+    const uint64_t originUs = (count_ != 0U)
+        ? edges_[first & (CAPACITY - 1U)].intendedUs : 0U;
+    file << "edge,level,intended_us,actual_us,deviation_us" << std::endl;
+    for (uint64_t i = first; i < count_; i++) {
+        const Edge & edge = edges_[i & (CAPACITY - 1U)];
+        file << i << ',' << (edge.level ? 1 : 0) << ','
+            << static_cast<int64_t>(edge.intendedUs - originUs) << ','
+            << static_cast<int64_t>(edge.actualUs - originUs) << ','
+            << static_cast<int64_t>(edge.actualUs - edge.intendedUs) << '\n';
+    }
+
+    if (!file.flush()) {
+        std::cerr << "Error: Trace file '" << traceFile_ << "' cannot be "
+            "written" << std::endl;
+        return false;
+    }
+
+    return true;
+}
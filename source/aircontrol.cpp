@@ -17,17 +17,32 @@
  * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <getopt.h>
+#include <unistd.h>
+
 #include <cstdint>
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
 #include <memory>
-#include <unistd.h>
-
-#include <wiringPi.h>
+#include <string>
+#include <vector>
 
+#include "Benchmark.h"
+#include "Clock.h"
 #include "Configuration.h"
+#include "Corpus.h"
+#include "GroupParameters.h"
+#include "Inspection.h"
 #include "InstanceLock.h"
+#include "Metrics.h"
+#include "MetricsParameters.h"
+#include "Render.h"
 #include "Replay.h"
+#include "RequestRing.h"
 #include "Scan.h"
+#include "Scene.h"
+#include "SelfTest.h"
 #include "Target.h"
 #include "Task.h"
 #include "Types.h"
@@ -43,19 +58,134 @@ static void printUsage(void) {
         << "Available options:" << std::endl
         << "  -c <file>\tConfiguration file ["
         << Configuration::DEFAULT_LOCATION << "]" << std::endl
-        << "  -d <file>\tDump air scan results to file" << std::endl
+        << "  -d <file>\tWrite air scan dump to file" << std::endl
+        << "  -f <frame>\tReplay only the given frame of the dump" << std::endl
         << "  -g <pin>\tOverride GPIO pin from configuration" << std::endl
         << "  -l\t\tPrevent multiple program instances" << std::endl
+        << "  -n <count>\tRepeat the replay given number of times [1]"
+        << std::endl
+        << "  -o <format>\tOutput format, text, json, target, frames or"
+        << " identify [text]" << std::endl
+        << "  -p <us>\tSampling rate of rendered and generated dumps"
+        << std::endl << "\t\t[scan samplingRate]" << std::endl
+        << "  -w <us>\tDelay between repeated replays [frame gap]"
+        << std::endl
+        << "  -x <file>\tTrace timing of all edges to CSV file" << std::endl
+        << "  --timings\tPrint the duration of all startup phases"
+        << std::endl
         << std::endl
         << "Available commands:" << std::endl
+        << "  -a <MB> [name=value ...]" << std::endl
+        << "\t\tGenerate synthetic air scan dump with given MB of samples"
+        << std::endl
+        << "  -b <file>\tBenchmark processing of given air scan dump"
+        << std::endl
+        << "  -e <target> [name=value ...]" << std::endl
+        << "\t\tLoopback self-test of target with the scan receiver"
+        << std::endl
+        << "  -i <file>\tInspect given air scan dump" << std::endl
+        << "  -m <target> [name=value ...]" << std::endl
+        << "\t\tRender target to air scan dump without GPIO access"
+        << std::endl
         << "  -r <file>\tReplay given air scan dump" << std::endl
         << "  -s <ms>\tAir scan for given period" << std::endl
-        << "  -t <target>\tExecute target configuration" << std::endl
+        << "  -t <target> [name=value ...]" << std::endl
+        << "\t\tExecute target configuration with template variables,"
+        << std::endl
+        << "\t\tmultiple targets are transmitted concurrently" << std::endl
         << std::endl
         << "Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>"
         << std::endl << std::endl;
 }
 
+/**
+ * @brief Print the duration of all startup phases to stderr.
+ * @param startUs Program start time (unit: microseconds).
+ * @param parsedUs Time the command line has been parsed (unit: microseconds).
+ * @param configuredUs Time the configuration has been loaded (unit:
+ *                     microseconds).
+ * @param timing Timing statistics of the task.
+ */
+static void printTimings(const uint64_t startUs, const uint64_t parsedUs,
+        const uint64_t configuredUs, const Task::Timing & timing) {
+    const int WIDTH = 12;
+    const auto printPhase = [WIDTH](const std::string & phase,
+            const uint64_t beginUs, const uint64_t endUs) {
+        std::cerr << "  " << std::left << std::setw(WIDTH) << phase + ":"
+            << std::right << std::setw(WIDTH) << endUs - beginUs << "us"
+            << std::endl;
+    };
+
+    std::cerr << "Startup timings:" << std::endl;
+    printPhase("Arguments", startUs, parsedUs);
+    printPhase("Config", parsedUs, configuredUs);
+    if (timing.gpioSetupUs == 0U) {
+        return;
+    }
+
+    printPhase("Validation", configuredUs, timing.gpioSetupUs);
+    printPhase("GPIO setup", timing.gpioSetupUs, timing.gpioReadyUs);
+    if (timing.edges != 0U) {
+        printPhase("First edge", timing.gpioReadyUs, timing.firstEdgeUs);
+        printPhase("Total", startUs, timing.firstEdgeUs);
+    }
+}
+
+/**
+ * @brief Transmit the targets of a request enqueued by another program
+ *        instance.
+ * @param location Configuration file location of this program instance.
+ * @param request Request to be executed.
+ * @return Program exit code.
+ */
+static int transmit(const std::string & location,
+        const RequestRing::Request & request) {
+    const uint64_t beginUs = Clock::now();
+    Configuration configuration;
+    configuration.setLocation(location);
+    MetricsParameters metricsParameters(configuration);
+    if (!configuration.load() || !metricsParameters.load()) {
+        return EXIT_FAILURE;
+    }
+
+    // Groups are executed as scene of their members
+    std::unique_ptr<Task> task;
+    std::string taskType;
+    std::string taskName;
+    if ((request.targets.size() == 1U)
+        && !GroupParameters::isGroup(configuration, request.targets.front())) {
+        task = std::make_unique<Target>(Target(configuration,
+            request.targets.front()));
+        taskType = "target";
+    } else {
+        task = std::make_unique<Scene>(Scene(configuration, request.targets));
+        taskType = "scene";
+    }
+    for (const auto & target : request.targets) {
+        taskName += (taskName.empty() ? "" : ",") + target;
+    }
+    if (!task->setArguments(request.arguments)) {
+        return EXIT_FAILURE;
+    }
+    task->setGpioPin(request.gpioPin);
+
+    const int exitCode = task->start();
+    const uint64_t endUs = Clock::now();
+
+    // The period the requesting instance waited counts as lock wait
+    if (!metricsParameters.getTextFile().empty()) {
+        Metrics metrics(metricsParameters.getTextFile());
+        metrics.addTask(taskType, taskName, task->getTiming(),
+            request.startUs, endUs, exitCode == EXIT_SUCCESS);
+        metrics.addLockWait(taskType, beginUs - request.startUs);
+
+        // The requested targets have been transmitted regardless
+        metrics.write();
+    }
+
+    return exitCode;
+}
+
 /**
  * @brief Main entry point.
  * @param argc Number of elements in argv.
@@ -63,16 +193,69 @@ static void printUsage(void) {
  * @return Exit code.
  */
 int main(int argc, char **argv) {
+    const uint64_t startUs = Clock::now();
     Configuration configuration;
     std::unique_ptr<Task> task;
+    std::string taskType;
+    std::string taskName;
+    std::vector<std::string> targetNames;
+    bool isLocked = false;
     uint8_t gpio = Types::INVALID_GPIO_PIN;
     std::string dumpFile;
+    std::string traceFile;
+    int32_t frame = 0;
+    int32_t repeat = 1;
+    int32_t repeatGap = Types::INVALID_PARAMETER;
+    int32_t samplingRate = Types::INVALID_PARAMETER;
+    Types::OutputFormat::OutputFormat_ outputFormat = Types::OutputFormat::TEXT;
+
+    // Long options are mapped to values beyond the range of characters
+    const int OPTION_TIMINGS = 256;
+    const struct option LONG_OPTIONS[] = {
+        { "timings", no_argument, nullptr, OPTION_TIMINGS },
+        { nullptr, 0, nullptr, 0 }
+    };
+    bool isTimings = false;
 
     // Parse command line arguments
     int option;
     opterr = 0;
-    while ((option = getopt(argc, argv, "c:d:g:lr:s:t:")) != -1) {
+    while ((option = getopt_long(argc, argv,
+            "a:b:c:d:e:f:g:i:lm:n:o:p:r:s:t:w:x:", LONG_OPTIONS, nullptr))
+            != -1) {
         switch (option) {
+            case 'a':
+                if (task != nullptr) {
+                    std::cerr << "Error: Multiple commands are not supported "
+                        "(maybe omit parameter '-a')" << std::endl;
+                    return EXIT_FAILURE;
+                } else if (dumpFile.empty()) {
+                    std::cerr << "Error: Generating requires parameter '-d' "
+                        "placed before the command" << std::endl;
+                    return EXIT_FAILURE;
+                } else if (atoi(optarg) <= 0) {
+                    std::cerr << "Error: Generated dump size must be >0MB"
+                        << std::endl;
+                    return EXIT_FAILURE;
+                }
+                task = std::make_unique<Corpus>(Corpus(configuration,
+                    atoi(optarg), dumpFile, samplingRate));
+                taskType = "corpus";
+                taskName = dumpFile;
+                break;
+
+            case 'b':
+                if (task != nullptr) {
+                    std::cerr << "Error: Multiple commands are not supported "
+                        "(maybe omit parameter '-b')" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                task = std::make_unique<Benchmark>(Benchmark(configuration,
+                    std::string(optarg), dumpFile));
+                taskType = "benchmark";
+                taskName = std::string(optarg);
+                break;
+
             case 'c':
                 configuration.setLocation(std::string(optarg));
                 break;
@@ -86,12 +269,111 @@ int main(int argc, char **argv) {
                 dumpFile = std::string(optarg);
                 break;
 
+            case 'e':
+                if (task != nullptr) {
+                    std::cerr << "Error: Multiple commands are not supported "
+                        "(maybe omit parameter '-e')" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                task = std::make_unique<SelfTest>(SelfTest(configuration,
+                    std::string(optarg)));
+                taskType = "selftest";
+                taskName = std::string(optarg);
+                break;
+
+            case 'f':
+                if (task != nullptr) {
+                    std::cerr << "Error: Parameter '-f' is an option and must "
+                        "be placed before the command" << std::endl;
+                    return EXIT_FAILURE;
+                } else if (atoi(optarg) <= 0) {
+                    std::cerr << "Error: Frame number must be >0" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                frame = atoi(optarg);
+                break;
+
             case 'g':
                 gpio = static_cast<uint8_t>(atoi(optarg));
                 break;
 
+            case 'i':
+                if (task != nullptr) {
+                    std::cerr << "Error: Multiple commands are not supported "
+                        "(maybe omit parameter '-i')" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                task = std::make_unique<Inspection>(Inspection(configuration,
+                    std::string(optarg), outputFormat));
+                taskType = "inspection";
+                taskName = std::string(optarg);
+                break;
+
             case 'l':
-                InstanceLock::lock();
+                isLocked = true;
+                break;
+
+            case 'm':
+                if (task != nullptr) {
+                    std::cerr << "Error: Multiple commands are not supported "
+                        "(maybe omit parameter '-m')" << std::endl;
+                    return EXIT_FAILURE;
+                } else if (dumpFile.empty()) {
+                    std::cerr << "Error: Rendering requires parameter '-d' "
+                        "placed before the command" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                task = std::make_unique<Render>(Render(configuration,
+                    std::string(optarg), dumpFile, samplingRate));
+                taskType = "render";
+                taskName = std::string(optarg);
+                break;
+
+            case 'n':
+                if (task != nullptr) {
+                    std::cerr << "Error: Parameter '-n' is an option and must "
+                        "be placed before the command" << std::endl;
+                    return EXIT_FAILURE;
+                } else if (atoi(optarg) <= 0) {
+                    std::cerr << "Error: Replay count must be >0" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                repeat = atoi(optarg);
+                break;
+
+            case 'o':
+                if (task != nullptr) {
+                    std::cerr << "Error: Parameter '-o' is an option and must "
+                        "be placed before the command" << std::endl;
+                    return EXIT_FAILURE;
+                } else if (std::string(optarg) == "text") {
+                    outputFormat = Types::OutputFormat::TEXT;
+                } else if (std::string(optarg) == "json") {
+                    outputFormat = Types::OutputFormat::JSON;
+                } else if (std::string(optarg) == "target") {
+                    outputFormat = Types::OutputFormat::TARGET;
+                } else if (std::string(optarg) == "frames") {
+                    outputFormat = Types::OutputFormat::FRAMES;
+                } else if (std::string(optarg) == "identify") {
+                    outputFormat = Types::OutputFormat::IDENTIFY;
+                } else {
+                    std::cerr << "Error: Output format '" << optarg
+                        << "' is not supported" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            case 'p':
+                if (task != nullptr) {
+                    std::cerr << "Error: Parameter '-p' is an option and must "
+                        "be placed before the command" << std::endl;
+                    return EXIT_FAILURE;
+                } else if (atoi(optarg) <= 0) {
+                    std::cerr << "Error: Sampling rate must be >0us"
+                        << std::endl;
+                    return EXIT_FAILURE;
+                }
+                samplingRate = atoi(optarg);
                 break;
 
             case 'r':
@@ -101,7 +383,9 @@ int main(int argc, char **argv) {
                     return EXIT_FAILURE;
                 }
                 task = std::make_unique<Replay>(Replay(configuration,
-                    std::string(optarg)));
+                    std::string(optarg), frame, repeat, repeatGap));
+                taskType = "replay";
+                taskName = std::string(optarg);
                 break;
 
             case 's':
@@ -113,19 +397,57 @@ int main(int argc, char **argv) {
                     std::cerr << "Error: Multiple commands are not supported "
                         "(maybe omit parameter '-s')" << std::endl;
                     return EXIT_FAILURE;
+                } else if (outputFormat == Types::OutputFormat::JSON) {
+                    std::cerr << "Error: Output format 'json' is not "
+                        "supported for air scans" << std::endl;
+                    return EXIT_FAILURE;
                 }
                 task = std::make_unique<Scan>(Scan(configuration,
-                    atoi(optarg), dumpFile));
+                    atoi(optarg), dumpFile, outputFormat));
+                taskType = "scan";
                 break;
 
             case 't':
-                if (task != nullptr) {
+                if ((task != nullptr) && targetNames.empty()) {
                     std::cerr << "Error: Multiple commands are not supported "
                         "(maybe omit parameter '-t')" << std::endl;
                     return EXIT_FAILURE;
                 }
-                task = std::make_unique<Target>(Target(configuration,
-                    std::string(optarg)));
+
+                // Multiple targets are transmitted concurrently as a scene
+                targetNames.push_back(std::string(optarg));
+                if (targetNames.size() == 1U) {
+                    task = std::make_unique<Target>(Target(configuration,
+                        targetNames.front()));
+                    taskType = "target";
+                    taskName = targetNames.front();
+                } else {
+                    task = std::make_unique<Scene>(Scene(configuration,
+                        targetNames));
+                    taskType = "scene";
+                    taskName += "," + targetNames.back();
+                }
+                break;
+
+            case 'w':
+                if (task != nullptr) {
+                    std::cerr << "Error: Parameter '-w' is an option and must "
+                        "be placed before the command" << std::endl;
+                    return EXIT_FAILURE;
+                } else if (atoi(optarg) < 0) {
+                    std::cerr << "Error: Replay delay must be >=0us"
+                        << std::endl;
+                    return EXIT_FAILURE;
+                }
+                repeatGap = atoi(optarg);
+                break;
+
+            case 'x':
+                traceFile = std::string(optarg);
+                break;
+
+            case OPTION_TIMINGS:
+                isTimings = true;
                 break;
 
             default:
@@ -134,20 +456,91 @@ int main(int argc, char **argv) {
         }
     }
     if (task == nullptr) {
-        std::cerr << "Error: Either parameter '-r', '-s' or '-t' is mandatory"
-            << std::endl;
+        std::cerr << "Error: Either parameter '-a', '-b', '-e', '-i', '-m', "
+            "'-r', '-s' or '-t' is mandatory" << std::endl;
         printUsage();
         return EXIT_FAILURE;
     }
 
+    // Targets are handed over to the instance holding the lock, which
+    // executes them after its own command without this instance loading the
+    // configuration. Both must use the same configuration file.
+    std::unique_ptr<RequestRing> ring;
+    if (isLocked) {
+        std::string location = configuration.getLocation();
+        char * resolved = realpath(location.c_str(), nullptr);
+        if (resolved != nullptr) {
+            location = resolved;
+            free(resolved);
+        }
+
+        ring = std::make_unique<RequestRing>(location,
+            [location](const RequestRing::Request & request) {
+            return transmit(location, request);
+        });
+        if (!ring->open()) {
+            ring = nullptr;
+        } else if (!targetNames.empty() && traceFile.empty() && !isTimings
+            && !InstanceLock::tryLock()) {
+            const RequestRing::Request request = { location, gpio,
+                targetNames, std::vector<std::string>(argv + optind,
+                argv + argc), startUs };
+
+            int exitCode;
+            if (ring->submit(request, exitCode)) {
+                return exitCode;
+            }
+        }
+        InstanceLock::lock();
+    }
+
     // Load the configuration
-    if (!configuration.load()) {
+    const uint64_t parsedUs = Clock::now();
+    MetricsParameters metricsParameters(configuration);
+    if (!configuration.load() || !metricsParameters.load()) {
         return EXIT_FAILURE;
     }
+    const uint64_t configuredUs = Clock::now();
 
-    // Setup wiringPi (no port re-mapping, use Broadcom GPIO numbers)
+    // Groups are executed as scene of their members
+    if ((targetNames.size() == 1U)
+        && GroupParameters::isGroup(configuration, targetNames.front())) {
+        task = std::make_unique<Scene>(Scene(configuration, targetNames));
+        taskType = "scene";
+    }
+    if (!task->setArguments(std::vector<std::string>(argv + optind,
+            argv + argc))) {
+        return EXIT_FAILURE;
+    }
+
+    // GPIO access is set up by the task itself if required
     task->setGpioPin(gpio);
-    wiringPiSetupGpio();
+    task->setTraceFile(traceFile);
+
+    const int exitCode = task->start();
+    const uint64_t endUs = Clock::now();
+    if (ring != nullptr) {
+        ring->lead();
+    }
+    if (isTimings) {
+        printTimings(startUs, parsedUs, configuredUs, task->getTiming());
+    }
+    if (!task->flushTrace()) {
+        return EXIT_FAILURE;
+    }
+
+    // Merge the metrics of this invocation into the metrics text file
+    if (!metricsParameters.getTextFile().empty()) {
+        Metrics metrics(metricsParameters.getTextFile());
+        metrics.addTask(taskType, taskName, task->getTiming(), startUs, endUs,
+            exitCode == EXIT_SUCCESS);
+        if (isLocked) {
+            metrics.addLockWait(taskType, InstanceLock::getWaitTime());
+        }
+
+        // A failure is only reported, the exit code remains the task's
+        metrics.write();
+    }
 
-    return task->start();
+    return exitCode;
 }
@@ -0,0 +1,188 @@
+/*
+ * This file is part of aircontrol.
+ *
+ * Copyright (C) 2014-2019 Ralf Dauberschmidt <ralf@dauberschmidt.de>
+ *
+ * aircontrol is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * aircontrol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with aircontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "RunDetector.h"
+#include "Types.h"
+
+namespace {
+
+/// Number of samples searched block by block by the vectorized kernels.
+const size_t BLOCK_SIZE = 64U;
+
+/// Number of bits per word of bit-packed samples.
+const size_t WORD_BITS = 64U;
+
+/**
+ * @param a First runs.
+ * @param b Second runs.
+ * @return True if both contain the same runs, false otherwise.
+ */
+bool isEqual(const std::vector<Types::Run> & a,
+        const std::vector<Types::Run> & b) {
+    return (a.size() == b.size()) && std::equal(a.begin(), a.end(), b.begin(),
+        [](const Types::Run & x, const Types::Run & y) {
+        return (x.level == y.level) && (x.samples == y.samples);
+    });
+}
+
+/**
+ * @param samples Byte samples.
+ * @return Bit-packed samples, least significant bit first.
+ */
+std::vector<uint64_t> pack(const std::vector<uint8_t> & samples) {
+    std::vector<uint64_t> words((samples.size() + WORD_BITS - 1U)
+        / WORD_BITS);
+    for (size_t i = 0U; i < samples.size(); i++) {
+        words[i / WORD_BITS] |= static_cast<uint64_t>(samples[i])
+            << (i % WORD_BITS);
+    }
+
+    return words;
+}
+
+/**
+ * A single transition is placed at every position of up to three blocks at
+ * every alignment, i.e. all block boundaries and tails are covered.
+ *
+ * @return True if the selected kernel finds all transitions, false otherwise.
+ */
+bool testTransitions(void) {
+    const size_t MAX_SIZE = 3U * BLOCK_SIZE + 1U;
+
+    std::vector<uint8_t> samples(BLOCK_SIZE + MAX_SIZE);
+    for (size_t offset = 0U; offset < BLOCK_SIZE; offset++) {
+        for (size_t size = 0U; size <= MAX_SIZE; size++) {
+            for (uint8_t level = 0U; level <= 1U; level++) {
+                for (size_t position = 0U; position <= size; position++) {
+                    std::fill(samples.begin(), samples.end(), level);
+                    if (position < size) {
+                        samples[offset + position] = level ^ 1U;
+                    }
+                    if (RunDetector::findTransition(&samples[offset], size,
+                            level) != position) {
+                        std::cerr << "Error: Transition at " << position
+                            << " of " << size << " samples at offset "
+                            << offset << " not found" << std::endl;
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Random runs around the block size, generated with a fixed seed like by the
+ * corpus generator, are detected at every alignment.
+ *
+ * @return True if the selected kernel and the bit-packed samples match the
+ *         scalar reference, false otherwise.
+ */
+bool testRuns(void) {
+    const size_t RUNS = 1024U;
+
+    std::mt19937 random(1U);
+    std::vector<uint8_t> samples;
+    for (size_t i = 0U; i < RUNS; i++) {
+        const size_t length = (i % 16U == 15U) ? BLOCK_SIZE * 16U
+            + random() % (BLOCK_SIZE * 64U)
+            : 1U + random() % (3U * BLOCK_SIZE + 1U);
+        samples.insert(samples.end(), length, (i % 2U != 0U) ? 1U : 0U);
+    }
+
+    for (size_t offset = 0U; offset < BLOCK_SIZE; offset++) {
+        const std::vector<uint8_t> aligned(samples.begin() + offset,
+            samples.end());
+        const std::vector<uint64_t> words = pack(aligned);
+
+        std::vector<Types::Run> reference;
+        std::vector<Types::Run> runs;
+        std::vector<Types::Run> packed;
+        RunDetector::detectScalar(aligned.data(), aligned.size(), reference);
+        RunDetector::detect(aligned.data(), aligned.size(), runs);
+        RunDetector::detectPacked(words.data(), aligned.size(), packed);
+        if (!isEqual(runs, reference) || !isEqual(packed, reference)) {
+            std::cerr << "Error: Runs at offset " << offset << " differ from "
+                "the scalar reference" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Runs exceeding UINT32_MAX samples are only created by merging with the
+ * preceding run, which all kernels share.
+ *
+ * @return True if merged runs are split, false otherwise.
+ */
+bool testSplit(void) {
+    const std::vector<uint8_t> samples(BLOCK_SIZE * 2U + 1U, 1U);
+    const std::vector<uint64_t> words = pack(samples);
+    const std::vector<Types::Run> expected = { { true, UINT32_MAX },
+        { true, static_cast<uint32_t>(samples.size() - BLOCK_SIZE) } };
+
+    std::vector<Types::Run> reference = { { true, UINT32_MAX - BLOCK_SIZE } };
+    std::vector<Types::Run> runs(reference);
+    std::vector<Types::Run> packed(reference);
+    RunDetector::detectScalar(samples.data(), samples.size(), reference);
+    RunDetector::detect(samples.data(), samples.size(), runs);
+    RunDetector::detectPacked(words.data(), samples.size(), packed);
+    if (!(isEqual(reference, expected) && isEqual(runs, expected)
+            && isEqual(packed, expected))) {
+        std::cerr << "Error: Runs exceeding " << UINT32_MAX << " samples are "
+            "not split" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+/**
+ * Verifies all kernels of RunDetector supported by the CPU against the
+ * scalar reference with synthetic samples.
+ *
+ * @return Program exit code.
+ */
+int main(void) {
+    bool isValid = true;
+
+    for (const auto & kernel : RunDetector::getKernels()) {
+        RunDetector::setKernel(kernel);
+        const bool isPassed = testTransitions() && testRuns() && testSplit();
+        std::cout << "RunDetector (" << kernel << "): "
+            << (isPassed ? "passed" : "FAILED") << std::endl;
+        isValid = isValid && isPassed;
+    }
+
+    return isValid ? EXIT_SUCCESS : EXIT_FAILURE;
+}